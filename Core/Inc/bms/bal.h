@@ -72,6 +72,18 @@ typedef struct {
     volt_t threshold;
 } BalParams;
 
+/**
+ * @brief Type definition for the canlib payload of the balancing status
+ *
+ * @details With the raw payload the structure is filled with the values
+ * already encoded and it is only packed before the transmission
+ */
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+typedef bms_cellboard_balancing_status_t bal_status_canlib_payload_t;
+#else  // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+typedef bms_cellboard_balancing_status_converted_t bal_status_canlib_payload_t;
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 /**
  * @brief Type definition for the balancing handler structure
  *
@@ -88,7 +100,7 @@ typedef struct {
  */
 typedef struct {
     fsm_event_data_t event;
-    bms_cellboard_balancing_status_converted_t status_can_payload;
+    bal_status_canlib_payload_t status_can_payload;
     Watchdog watchdog;
 
     BalStatus status;
@@ -171,9 +183,9 @@ BalReturnCode bal_resume(void);
  *
  * @param byte_size[out] A pointer where the size of the payload in bytes is stored (can be NULL)
  *
- * @return bms_cellboard_balancing_status_converted_t* A pointer to the payload
+ * @return bal_status_canlib_payload_t* A pointer to the payload
  */
-bms_cellboard_balancing_status_converted_t * bal_get_status_canlib_payload(size_t * const byte_size);
+bal_status_canlib_payload_t * bal_get_status_canlib_payload(size_t * const byte_size);
 
 #else  // CONF_BALANCING_MODULE_ENABLE
 
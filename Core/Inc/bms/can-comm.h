@@ -12,12 +12,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdatomic.h>
 
 #include "cellboard-conf.h"
 #include "cellboard-def.h"
 
 #include "bms_network.h"
-#include "ring-buffer.h"
 
 /** @brief Maximum number of bytes of the payload in a CAN message */
 #define CAN_COMM_MAX_PAYLOAD_BYTE_SIZE (8U)
@@ -26,10 +26,45 @@
 #define CAN_COMM_ID_MASK (0x7FFU)
 #define CAN_COMM_EXT_ID_MASK (0x1FFFFFFFU)
 
+/** @brief Maximum size in bytes of a payload before its serialization */
+#define CAN_COMM_TX_MAILBOX_BYTE_SIZE (bms_MAX_STRUCT_SIZE_CONVERSION)
+
+/** @brief Maximum size in bytes of a payload after its serialization */
+#define CAN_COMM_TX_FRAME_BYTE_SIZE (CAN_COMM_MAX_PAYLOAD_BYTE_SIZE)
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Number of bins of the latency histogram of each message
+ *
+ * @details The first bin counts the latencies lower than 2^CAN_COMM_STATS_LATENCY_FIRST_BIN_BIT
+ * timestamp counts, the upper limit doubles at every bin and the last one
+ * counts all the remaining latencies
+ * @details With the timestamp counter incremented at every bit time at 1 Mbit/s
+ * the limits go from 128 us to 8.192 ms
+ */
+#define CAN_COMM_STATS_LATENCY_BIN_COUNT (8U)
+#define CAN_COMM_STATS_LATENCY_FIRST_BIN_BIT (7U)
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
 /** @brief Maximum number of CAN messages that can be saved inside the transmission and reception buffers */
 #define CAN_COMM_MESSAGE_COUNT (bms_MESSAGE_COUNT)
-#define CAN_COMM_TX_BUFFER_BYTE_SIZE (CAN_COMM_MESSAGE_COUNT)
-#define CAN_COMM_RX_BUFFER_BYTE_SIZE (CAN_COMM_MESSAGE_COUNT)
+
+/**
+ * @brief Number of messages sent by the cellboard
+ *
+ * @attention Must match the length of the list of the sent messages
+ */
+#define CAN_COMM_TX_SENT_COUNT (8U)
+
+/**
+ * @brief Maximum number of received CAN messages waiting to be handled
+ *
+ * @attention The size must be a power of two
+ */
+#define CAN_COMM_RX_QUEUE_SIZE (32U)
+#define CAN_COMM_RX_QUEUE_MASK (CAN_COMM_RX_QUEUE_SIZE - 1U)
 
 /** @brief Mask for the bits that defines if the CAN module is enabled or not */
 #define CAN_COMM_ENABLED_ALL_MASK \
@@ -109,6 +144,7 @@
  *     - CAN_COMM_INVALID_FRAME_TYPE the frame type does not correspond to any existing CAN frame type
  *     - CAN_COMM_CONVERSION_ERROR the message could not be converted correctly
  *     - CAN_COMM_TRANSMISSION_ERROR there was an error during the transmission of the message
+ *     - CAN_COMM_BUSY the transmission hardware can't accept any more messages
  */
 typedef enum {
     CAN_COMM_OK,
@@ -119,7 +155,8 @@ typedef enum {
     CAN_COMM_INVALID_PAYLOAD_SIZE,
     CAN_COMM_INVALID_FRAME_TYPE,
     CAN_COMM_CONVERSION_ERROR,
-    CAN_COMM_TRANSMISSION_ERROR
+    CAN_COMM_TRANSMISSION_ERROR,
+    CAN_COMM_BUSY
 } CanCommReturnCode;
 
 /**
@@ -163,6 +200,24 @@ typedef struct {
     CanPayload payload;
 } CanMessage;
 
+/**
+ * @brief Single-producer single-consumer queue of the received messages
+ *
+ * @details The reception interrupt is the only producer and the routine is
+ * the only consumer, each index is written by one side only so that no
+ * critical section is needed
+ * @details The indices are free-running and are masked to access the data
+ *
+ * @param head Index of the next message to write, updated only by the producer
+ * @param tail Index of the next message to read, updated only by the consumer
+ * @param data The received messages
+ */
+typedef struct {
+    atomic_size_t head;
+    atomic_size_t tail;
+    CanMessage data[CAN_COMM_RX_QUEUE_SIZE];
+} CanCommRxQueue;
+
 
 /**
  * @brief Function used to send CAN message via a network
@@ -172,7 +227,8 @@ typedef struct {
  * @param data The actual payload of the message
  * @param size The size of the payload
  *
- * @return CanCommReturnCode The return code value
+ * @return CanCommReturnCode The return code value, CAN_COMM_BUSY if the
+ * hardware has no room for the message so that it can be sent afterwards
  */
 typedef CanCommReturnCode (* can_comm_transmit_callback_t)(
     // CanNetwork network, // Not needed because the cellboards have only the BMS network
@@ -183,42 +239,137 @@ typedef CanCommReturnCode (* can_comm_transmit_callback_t)(
 );
 
 /**
- * @brief Handle the received CAN payload data
+ * @brief Function used to read the timestamp counter of the CAN peripheral
+ *
+ * @details The counter is the same used to mark the transmitted frames inside
+ * the transmission events so that the latencies can be computed
  *
- * @details The payload parameter should be converted to the correct structure pointer
+ * @return uint16_t The counter value
+ */
+typedef uint16_t (* can_comm_timestamp_get_callback_t)(void);
+
+/**
+ * @brief Serialize the payload of a single message
  *
  * @param payload A pointer to the converted canlib structure data
+ * @param data The array where the serialized payload is written
+ *
+ * @return int The size of the serialized payload in bytes or a negative value on error
+ */
+typedef int (* can_comm_canlib_serialize_callback_t)(const void * const payload, uint8_t * const data);
+
+/**
+ * @brief Deserialize the payload of a single received message and handle it
+ *
+ * @param data The received raw payload
  */
-typedef void (* can_comm_canlib_payload_handle_callback_t)(const void * const payload);
+typedef void (* can_comm_canlib_deserialize_callback_t)(const uint8_t * const data);
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Transmission statistics of a single message
+ *
+ * @details The latency is the time from the moment the message starts
+ * waiting inside its mailbox to the start of its frame on the bus, expressed
+ * in counts of the timestamp counter
+ *
+ * @attention The timestamp counter is 16 bits wide so latencies longer than
+ * its period (65.5 ms at 1 Mbit/s) can't be measured correctly
+ *
+ * @param sent Number of frames confirmed by the transmission events
+ * @param overwritten Number of payloads replaced by a newer one before being sent
+ * @param errors Number of transmissions refused by the hardware
+ * @param latency_max The maximum latency
+ * @param latency_hist Histogram of the latencies with logarithmic bins
+ */
+typedef struct {
+    uint32_t sent;
+    uint32_t overwritten;
+    uint32_t errors;
+    uint16_t latency_max;
+    uint32_t latency_hist[CAN_COMM_STATS_LATENCY_BIN_COUNT];
+} CanCommTxStats;
+
+/**
+ * @brief Statistics of the CAN communication
+ *
+ * @param tx Transmission statistics indexed by the position of the message inside the list of the sent messages
+ * @param tx_pending_max Maximum number of messages waiting to be sent at the same time
+ * @param rx_queue_max Maximum number of received messages waiting to be handled at the same time
+ * @param rx_overrun Number of received messages discarded because the queue was full
+ */
+typedef struct {
+    CanCommTxStats tx[CAN_COMM_TX_SENT_COUNT];
+    uint8_t tx_pending_max;
+    uint8_t rx_queue_max;
+    uint32_t rx_overrun;
+} CanCommStats;
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
 
 /**
  * @brief CAN manager handler structure
  *
  * @details The enabled bit flag 
  *
+ * @details Each message to transmit has its own mailbox where only the latest
+ * payload is kept, the order of transmission is given by a queue of indices
+ * @details The transmission buffers are indexed by the position of the message
+ * inside the list of the sent messages instead of the canlib index
+ * @details The last serialized frame of each message is kept so that the
+ * payloads that rarely change are not serialized again at every transmission
+ *
  * @param enabled Flag used to enable or disable the CAN communication
- * @param tx_busy Transmission messages flags to check if the message has not already been sent
- * @param rx_busy Reception messages flags to check if the message has not already been handled
- * @param tx_buf Transmission messages circular buffer
- * @param rx_buf Reception messages circular buffer
+ * @param tx_frame_type The frame type of the message inside each transmission mailbox
+ * @param tx_mailbox The latest payload of each message waiting to be sent
+ * @param tx_dirty Flags set by the producers to notify that the payload of a cached message has changed
+ * @param tx_frame_valid Flags to check if the serialized frame matches the payload inside the mailbox
+ * @param tx_frame_serialized Flags to check if the frame was serialized after the last transmission of the message
+ * @param tx_frame_size The size in bytes of each serialized frame
+ * @param tx_frame The last serialized frame of each message
+ * @param tx_cache_hit Number of messages sent without serializing their payload again
+ * @param tx_cache_miss Number of messages sent after the serialization of their payload
+ * @param tx_pending Bit flag of the messages waiting to be sent indexed by their priority
+ * @param rx_queue Queue of the received messages waiting to be handled
  * @param send A pointer to the callback used to send the data via CAN
- * @param rx_device The reception canlib message handler
- * @param rx_raw The reception raw data of the message
- * @param rx_conv The reception converted data of the message
+ * @param cs_enter A pointer to the callback used to enter a critical section
+ * @param cs_exit A pointer to the callback used to exit a critical section
+ * @param tx_ret The return code of the last transmission done by the interrupt
+ * @param tx_ret_updated True if the last transmission result was not checked yet, false otherwise
+ * @param stats The statistics of the communication
+ * @param timestamp_get A pointer to the callback used to read the timestamp counter
+ * @param tx_enqueue_time Value of the timestamp counter when each message started waiting inside its mailbox
+ * @param tx_in_flight_time The enqueue time of the last frame of each message accepted by the hardware
+ * @param tx_in_flight Flags to check if the hardware accepted a frame whose transmission event was not received yet
  */
 typedef struct  {
     bit_flag8_t enabled;
-    bool tx_busy[CAN_COMM_MESSAGE_COUNT];
-    bool rx_busy[CAN_COMM_MESSAGE_COUNT];
-    RingBuffer(CanMessage, CAN_COMM_TX_BUFFER_BYTE_SIZE) tx_buf;
-    RingBuffer(CanMessage, CAN_COMM_RX_BUFFER_BYTE_SIZE) rx_buf;
+    CanFrameType tx_frame_type[CAN_COMM_TX_SENT_COUNT];
+    uint8_t tx_mailbox[CAN_COMM_TX_SENT_COUNT][CAN_COMM_TX_MAILBOX_BYTE_SIZE];
+    bool tx_dirty[CAN_COMM_TX_SENT_COUNT];
+    bool tx_frame_valid[CAN_COMM_TX_SENT_COUNT];
+    bool tx_frame_serialized[CAN_COMM_TX_SENT_COUNT];
+    uint8_t tx_frame_size[CAN_COMM_TX_SENT_COUNT];
+    uint8_t tx_frame[CAN_COMM_TX_SENT_COUNT][CAN_COMM_TX_FRAME_BYTE_SIZE];
+    uint32_t tx_cache_hit;
+    uint32_t tx_cache_miss;
+    bit_flag32_t tx_pending;
+    CanCommRxQueue rx_queue;
 
     can_comm_transmit_callback_t send;
-
-    // Canlib devices
-    device_t rx_device;
-    uint8_t rx_raw[bms_MAX_STRUCT_SIZE_RAW];
-    uint8_t rx_conv[bms_MAX_STRUCT_SIZE_CONVERSION];
+    interrupt_critical_section_enter_t cs_enter;
+    interrupt_critical_section_exit_t cs_exit;
+    _VOLATILE CanCommReturnCode tx_ret;
+    _VOLATILE bool tx_ret_updated;
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+    CanCommStats stats;
+    can_comm_timestamp_get_callback_t timestamp_get;
+    uint16_t tx_enqueue_time[CAN_COMM_TX_SENT_COUNT];
+    uint16_t tx_in_flight_time[CAN_COMM_TX_SENT_COUNT];
+    bool tx_in_flight[CAN_COMM_TX_SENT_COUNT];
+#endif // CONF_CAN_COMM_STATS_ENABLE
 } _CanCommHandler;
 
 
@@ -227,13 +378,22 @@ typedef struct  {
 /**
  * @brief Initialize the CAN communication handler structure
  *
+ * @details The critical section callbacks are used to protect the transmission
+ * queue when the messages are sent from the transmission complete interrupt
+ *
  * @param send The callback of a function that should send the data via a CAN network
+ * @param cs_enter A pointer to the callback used to enter a critical section
+ * @param cs_exit A pointer to the callback used to exit a critical section
  *
  * @return CanCommReturnCode
  *     - CAN_COMM_NULL_POINTER a NULL pointer was given as parameter
  *     - CAN_COMM_OK otherwise
  */
-CanCommReturnCode can_comm_init(const can_comm_transmit_callback_t send);
+CanCommReturnCode can_comm_init(
+    const can_comm_transmit_callback_t send,
+    const interrupt_critical_section_enter_t cs_enter,
+    const interrupt_critical_section_exit_t cs_exit
+);
 
 /** @brief Enable the CAN manager */
 void can_comm_enable_all(void);
@@ -274,8 +434,7 @@ bool can_comm_is_enabled(const CanCommEnableBit bit);
 /**
  * @brief Immediately send the message via the CAN bus
  *
- * @attention This function should be used carefully because it can run the
- * routine multiple times internally
+ * @details The message is sent directly without passing through its mailbox
  *
  * @param index The CAN index mapped to its identifier
  * @param frame_type The frame type
@@ -284,11 +443,11 @@ bool can_comm_is_enabled(const CanCommEnableBit bit);
  *
  * @return CanCommReturnCode
  *     - CAN_COMM_DISABLED the CAN manager is disabled
- *     - CAN_COMM_INVALID_INDEX if the given index does not match any valid CAN identifier
+ *     - CAN_COMM_INVALID_INDEX if the given index does not match any message sent by the cellboard
  *     - CAN_COMM_INVALID_PAYLOAD_SIZE the given payload size exceed the maximum possible length
  *     - CAN_COMM_INVALID_FRAME_TYPE the given frame type is not a valid CAN frame type
- *     - CAN_COMM_OVERRUN the transmission buffer is already full
  *     - CAN_COMM_CONVERSION_ERROR there was an error during the conversion of the message
+ *     - CAN_COMM_BUSY the transmission hardware can't accept any more messages
  *     - CAN_COMM_OK otherwise
  */
 CanCommReturnCode can_comm_send_immediate(
@@ -301,7 +460,12 @@ CanCommReturnCode can_comm_send_immediate(
 /**
  * @brief Add a message to the transmission buffer
  *
- * @details The message will be sent afterwards inside the routine
+ * @details The message will be sent afterwards inside the routine, or as soon
+ * as the hardware has room for it if the transmission interrupt is used
+ * @details The waiting messages are sent in order of their identifier, the
+ * lowest first, as the bus arbitration would do
+ * @details If the same message is still waiting to be sent its payload is
+ * overwritten and it is sent only once
  *
  * @param index The CAN index mapped to its identifier
  * @param frame_type The frame type
@@ -310,10 +474,9 @@ CanCommReturnCode can_comm_send_immediate(
  *
  * @return CanCommReturnCode
  *     - CAN_COMM_DISABLED the CAN manager is disabled
- *     - CAN_COMM_INVALID_INDEX if the given index does not match any valid CAN identifier
+ *     - CAN_COMM_INVALID_INDEX if the given index does not match any message sent by the cellboard
  *     - CAN_COMM_INVALID_PAYLOAD_SIZE the given payload size exceed the maximum possible length
  *     - CAN_COMM_INVALID_FRAME_TYPE the given frame type is not a valid CAN frame type
- *     - CAN_COMM_OVERRUN the transmission buffer is already full
  *     - CAN_COMM_OK otherwise
  */
 CanCommReturnCode can_comm_tx_add(
@@ -325,9 +488,16 @@ CanCommReturnCode can_comm_tx_add(
 );
 
 /**
- * @brief Add a message to the reception buffer
+ * @brief Add a message to the reception queue
  *
  * @details The message will be handled afterwards inside the routine
+ * @details This function is wait-free and can be called from the reception
+ * interrupt without disabling the routine
+ * @details Remote frames are rejected, every cellboard sends the same
+ * identifiers so an answer from each of them would collide on the bus
+ *
+ * @attention Only a single caller (e.g. the reception interrupt) can add the
+ * received messages
  *
  * @param index The CAN index mapped to its identifier
  * @param frame_type The frame type
@@ -337,8 +507,8 @@ CanCommReturnCode can_comm_tx_add(
  * @return CanCommReturnCode
  *     - CAN_COMM_DISABLED the CAN manager is disabled
  *     - CAN_COMM_INVALID_PAYLOAD_SIZE the given payload size exceed the maximum possible length
- *     - CAN_COMM_INVALID_FRAME_TYPE the given frame type is not a valid CAN frame type
- *     - CAN_COMM_OVERRUN the transmission buffer is already full
+ *     - CAN_COMM_INVALID_FRAME_TYPE the given frame type is not a valid CAN frame type or it is a REMOTE frame
+ *     - CAN_COMM_OVERRUN the reception queue is already full
  *     - CAN_COMM_OK otherwise
  */
 CanCommReturnCode can_comm_rx_add(
@@ -349,9 +519,93 @@ CanCommReturnCode can_comm_rx_add(
     const size_t size
 );
 
+/**
+ * @brief Get the identifiers of the received messages that are handled by the cellboard
+ *
+ * @details The identifiers can be used to configure the hardware acceptance
+ * filters so that any other message is discarded before reaching the CPU
+ *
+ * @param ids The array where the identifiers are copied
+ * @param size The maximum number of identifiers that can be copied
+ *
+ * @return size_t The number of copied identifiers
+ */
+size_t can_comm_get_rx_ids(can_id_t * const ids, const size_t size);
+
+/**
+ * @brief Get the index of a received message from the hardware filter that accepted it
+ *
+ * @details The filter with the same position of an identifier given by
+ * can_comm_get_rx_ids accepts only that identifier, so the filter index is a
+ * perfect hash of the received identifiers that is computed by the hardware
+ *
+ * @param filter The index of the filter that accepted the message
+ *
+ * @return can_index_t The message index or CAN_COMM_MESSAGE_COUNT if the filter is not valid
+ */
+can_index_t can_comm_get_rx_index(const size_t filter);
+
+/**
+ * @brief Notify that the payload of a message has changed since its last addition
+ *
+ * @details The payloads of the cached messages are serialized again only
+ * after this function is called by the module that produces them, the
+ * payloads of the other messages are serialized at every addition
+ * @details The last serialized frame is discarded at the next addition of the
+ * message, so the function can be called before or after the payload is updated
+ *
+ * @param index The CAN index mapped to its identifier
+ */
+void can_comm_tx_set_dirty(const can_index_t index);
+
+/**
+ * @brief Get the number of messages sent without serializing their payload again
+ *
+ * @return uint32_t The number of cache hits
+ */
+uint32_t can_comm_get_tx_cache_hit_count(void);
+
+/**
+ * @brief Get the number of messages sent after the serialization of their payload
+ *
+ * @return uint32_t The number of cache misses
+ */
+uint32_t can_comm_get_tx_cache_miss_count(void);
+
+/**
+ * @brief Get the number of messages waiting to be sent
+ *
+ * @return size_t The number of messages inside their mailboxes
+ */
+size_t can_comm_tx_get_pending_count(void);
+
+/**
+ * @brief Check if a message is waiting to be sent
+ *
+ * @param index The CAN index mapped to its identifier
+ *
+ * @return bool True if the message is inside its mailbox, false otherwise
+ */
+bool can_comm_tx_is_pending(const can_index_t index);
+
+/**
+ * @brief Check if there are no messages waiting to be sent or handled
+ *
+ * @details The messages of a disabled direction (transmission or reception) are ignored
+ * @details The messages waiting to be sent are ignored if they are sent from
+ * the transmission complete interrupt
+ *
+ * @return bool True if both buffers are empty, false otherwise
+ */
+bool can_comm_is_idle(void);
+
 /**
  * @brief Routine used to manage the sent or received can data
  *
+ * @details Every received message waiting inside the queue is handled in a single call
+ * @details Only the received messages are handled if the messages to send are
+ * sent from the transmission complete interrupt
+ *
  * @return CanCommReturnCode
  *     - CAN_COMM_DISABLED the CAN manager is not running
  *     - CAN_COMM_CONVERSION_ERROR there was an error during the conversion of the message
@@ -359,9 +613,79 @@ CanCommReturnCode can_comm_rx_add(
  */
 CanCommReturnCode can_comm_routine(void);
 
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+
+/**
+ * @brief Send the messages waiting in the queue until the hardware can't accept any more of them
+ *
+ * @attention This function should be called only from the transmission complete interrupt
+ */
+void can_comm_tx_pump(void);
+
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+
+#define can_comm_tx_pump() CELLBOARD_NOPE()
+
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Initialize the statistics of the CAN communication
+ *
+ * @attention This function has to be called after the CAN manager initialization
+ *
+ * @param timestamp_get A pointer to the function that reads the timestamp counter
+ *
+ * @return CanCommReturnCode
+ *     - CAN_COMM_NULL_POINTER if the timestamp callback is NULL
+ *     - CAN_COMM_OK otherwise
+ */
+CanCommReturnCode can_comm_stats_init(const can_comm_timestamp_get_callback_t timestamp_get);
+
+/** @brief Reset all the statistics of the CAN communication */
+void can_comm_stats_reset(void);
+
+/**
+ * @brief Get the statistics of the CAN communication
+ *
+ * @return const CanCommStats* A pointer to the statistics
+ */
+const CanCommStats * can_comm_stats_get(void);
+
+/**
+ * @brief Get the transmission statistics of a single message
+ *
+ * @param index The CAN index mapped to its identifier
+ *
+ * @return const CanCommTxStats* A pointer to the statistics or NULL if the message is not sent by the cellboard
+ */
+const CanCommTxStats * can_comm_stats_get_tx(const can_index_t index);
+
+/**
+ * @brief Update the statistics with a transmission event of the hardware
+ *
+ * @attention This function should be called only from the interrupt that
+ * reads the transmission events
+ *
+ * @param id The identifier of the transmitted frame
+ * @param timestamp The value of the timestamp counter at the start of the frame
+ */
+void can_comm_stats_notify_tx_event(const can_id_t id, const uint16_t timestamp);
+
+#else  // CONF_CAN_COMM_STATS_ENABLE
+
+#define can_comm_stats_init(timestamp_get) (CAN_COMM_OK)
+#define can_comm_stats_reset() CELLBOARD_NOPE()
+#define can_comm_stats_get() (NULL)
+#define can_comm_stats_get_tx(index) (NULL)
+#define can_comm_stats_notify_tx_event(id, timestamp) CELLBOARD_NOPE()
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
 #else  // CONF_CAN_COMM_MODULE_ENABLE
 
-#define can_comm_init(send) (CAN_COMM_OK)
+#define can_comm_init(send, cs_enter, cs_exit) (CAN_COMM_OK)
 #define can_comm_enable_all() CELLBOARD_NOPE()
 #define can_comm_disable_all() CELLBOARD_NOPE()
 #define can_comm_is_enabled_all() (false)
@@ -371,7 +695,21 @@ CanCommReturnCode can_comm_routine(void);
 #define can_comm_send_immidiate(index, frame_type, data, size) (CAN_COMM_OK)
 #define can_comm_tx_add(index, frame_type, data, size) (CAN_COMM_OK)
 #define can_comm_rx_add(index, frame_type, data, size) (CAN_COMM_OK)
+#define can_comm_get_rx_ids(ids, size) (0U)
+#define can_comm_get_rx_index(filter) (CAN_COMM_MESSAGE_COUNT)
+#define can_comm_tx_set_dirty(index) CELLBOARD_NOPE()
+#define can_comm_get_tx_cache_hit_count() (0U)
+#define can_comm_get_tx_cache_miss_count() (0U)
+#define can_comm_tx_get_pending_count() (0U)
+#define can_comm_tx_is_pending(index) (false)
+#define can_comm_is_idle() (true)
 #define can_comm_routine() (CAN_COMM_OK)
+#define can_comm_tx_pump() CELLBOARD_NOPE()
+#define can_comm_stats_init(timestamp_get) (CAN_COMM_OK)
+#define can_comm_stats_reset() CELLBOARD_NOPE()
+#define can_comm_stats_get() (NULL)
+#define can_comm_stats_get_tx(index) (NULL)
+#define can_comm_stats_notify_tx_event(id, timestamp) CELLBOARD_NOPE()
 
 #endif // CONF_CAN_COMM_MODULE_ENABLE
 
@@ -0,0 +1,176 @@
+/**
+ * @file idle.h
+ * @date 2024-10-16
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ *
+ * @brief Functions used to put the microcontroller to sleep when there is
+ * nothing left to do inside the main loop
+ */
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cellboard-conf.h"
+#include "cellboard-def.h"
+
+/**
+ * @brief Return code for the idle module functions
+ *
+ * @details
+ *     - IDLE_OK the function executed succesfully
+ *     - IDLE_NULL_POINTER a NULL pointer was given to a function
+ *     - IDLE_DISABLED the idle handler is not enabled
+ *     - IDLE_BUSY there is still work to do so the microcontroller was not put to sleep
+ */
+typedef enum {
+    IDLE_OK,
+    IDLE_NULL_POINTER,
+    IDLE_DISABLED,
+    IDLE_BUSY
+} IdleReturnCode;
+
+/**
+ * @brief Reasons that can wake up the microcontroller
+ *
+ * @details
+ *     - IDLE_WAKE_REASON_TIMEBASE the timebase tick or alarm interrupt
+ *     - IDLE_WAKE_REASON_CAN a CAN message was received
+ *     - IDLE_WAKE_REASON_ADC an ADC conversion is completed
+ *     - IDLE_WAKE_REASON_OTHER any other interrupt that was not notified
+ */
+typedef enum {
+    IDLE_WAKE_REASON_TIMEBASE,
+    IDLE_WAKE_REASON_CAN,
+    IDLE_WAKE_REASON_ADC,
+    IDLE_WAKE_REASON_OTHER,
+
+    IDLE_WAKE_REASON_COUNT
+} IdleWakeReason;
+
+/**
+ * @brief Callback used to put the microcontroller to sleep until an interrupt occurs
+ *
+ * @attention This function is called with the interrupts disabled and must
+ * return as soon as an interrupt is pending (e.g. with the WFI instruction)
+ */
+typedef void (* idle_sleep_callback_t)(void);
+
+/**
+ * @brief Idle handler structure
+ *
+ * @attention This structure should not be used outside of this module
+ *
+ * @param enabled True if the microcontroller can be put to sleep, false otherwise
+ * @param sleep A pointer to the callback used to put the microcontroller to sleep
+ * @param cs_enter A pointer to the callback used to enter a critical section
+ * @param cs_exit A pointer to the callback used to exit a critical section
+ * @param reasons Bit flag of the reasons notified while the microcontroller was sleeping
+ * @param loop_count The number of times the routine was called
+ * @param sleep_count The number of times the microcontroller was put to sleep
+ * @param wake_count The number of wake ups for each reason
+ */
+typedef struct {
+    bool enabled;
+    idle_sleep_callback_t sleep;
+    interrupt_critical_section_enter_t cs_enter;
+    interrupt_critical_section_exit_t cs_exit;
+
+    _VOLATILE bit_flag8_t reasons;
+    uint32_t loop_count;
+    uint32_t sleep_count;
+    uint32_t wake_count[IDLE_WAKE_REASON_COUNT];
+} _IdleHandler;
+
+#ifdef CONF_IDLE_MODULE_ENABLE
+
+/**
+ * @brief Initialize the idle handler
+ *
+ * @details The idle handler is disabled by default after initialization
+ *
+ * @param sleep A pointer to the callback used to put the microcontroller to sleep
+ * @param cs_enter A pointer to the callback used to enter a critical section
+ * @param cs_exit A pointer to the callback used to exit a critical section
+ *
+ * @return IdleReturnCode
+ *     - IDLE_NULL_POINTER if any of the callbacks is NULL
+ *     - IDLE_OK otherwise
+ */
+IdleReturnCode idle_init(
+    const idle_sleep_callback_t sleep,
+    const interrupt_critical_section_enter_t cs_enter,
+    const interrupt_critical_section_exit_t cs_exit
+);
+
+/**
+ * @brief Enable or disable the idle handler
+ *
+ * @param enabled True to allow the microcontroller to sleep, false otherwise
+ */
+void idle_set_enable(const bool enabled);
+
+/**
+ * @brief Notify the reason why the microcontroller was woken up
+ *
+ * @attention This function should be called from the interrupts that should wake up the microcontroller
+ *
+ * @param reason The wake up reason
+ */
+void idle_notify(const IdleWakeReason reason);
+
+/**
+ * @brief Put the microcontroller to sleep if there is nothing left to do
+ *
+ * @details The microcontroller sleeps until the next deadline of the timebase
+ * or until an interrupt (e.g. CAN reception or ADC conversion) occurs
+ * The check and the sleep are done with the interrupts disabled so that
+ * an interrupt that occurs in between wakes up the microcontroller immediately
+ *
+ * @return IdleReturnCode
+ *     - IDLE_DISABLED if the idle handler is disabled
+ *     - IDLE_BUSY if there is still work to do
+ *     - IDLE_OK otherwise
+ */
+IdleReturnCode idle_routine(void);
+
+/**
+ * @brief Get the number of times the idle routine was called
+ *
+ * @return uint32_t The number of main loop iterations
+ */
+uint32_t idle_get_loop_count(void);
+
+/**
+ * @brief Get the number of times the microcontroller was put to sleep
+ *
+ * @return uint32_t The number of sleeps
+ */
+uint32_t idle_get_sleep_count(void);
+
+/**
+ * @brief Get the number of wake ups caused by a specific reason
+ *
+ * @details A single wake up can be counted for more than one reason
+ *
+ * @param reason The wake up reason
+ *
+ * @return uint32_t The number of wake ups or 0 if the reason is not valid
+ */
+uint32_t idle_get_wake_count(const IdleWakeReason reason);
+
+#else  // CONF_IDLE_MODULE_ENABLE
+
+#define idle_init(sleep, cs_enter, cs_exit) (IDLE_OK)
+#define idle_set_enable(enabled) CELLBOARD_NOPE()
+#define idle_notify(reason) CELLBOARD_NOPE()
+#define idle_routine() (IDLE_DISABLED)
+#define idle_get_loop_count() (0U)
+#define idle_get_sleep_count() (0U)
+#define idle_get_wake_count(reason) (0U)
+
+#endif // CONF_IDLE_MODULE_ENABLE
+
+#endif // IDLE_H
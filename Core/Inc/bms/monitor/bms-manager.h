@@ -36,7 +36,7 @@
  * @return volt_t The converted voltage value in V
  */
 // TODO: Move macro into the bms monitor library
-#define BMS_MANAGER_RAW_VOLTAGE_TO_VOLT(value) ((value) * 0.0001f)
+#define BMS_MANAGER_RAW_VOLTAGE_TO_VOLT(value) VOLT_RAW_TO_VOLT(value)
 
 /**
  * @brief Convert the raw value read from the GPIO of the LTCs to a voltage value in V
@@ -14,8 +14,10 @@
 #include "cellboard-def.h"
 
 #include "can-comm.h"
+#include "timebase.h"
 #include "bms-manager.h"
 #include "led.h"
+#include "idle.h"
 #include "temp.h"
 
 /**
@@ -39,7 +41,12 @@ typedef enum {
  *
  * @param id The current cellboard index
  * @param system_reset A pointer to a function that resets the microcontroller
+ * @param clock_get A pointer to a function that reads the free-running counter used by the timebase (can be NULL)
+ * @param clock_set_alarm A pointer to a function that sets the alarm of the free-running counter (can be NULL)
+ * @param profiler_clock_get A pointer to a function that reads the clock used to profile the tasks (can be NULL)
+ * @param sleep A pointer to a function that puts the microcontroller to sleep until an interrupt occurs
  * @param can_send A pointer to a function that can send data via the CAN bus
+ * @param can_timestamp_get A pointer to a function that reads the timestamp counter of the CAN peripheral (can be NULL)
  * @param spi_send A pointer to a function that can send data via the SPI peripheral
  * @param spi_send_receive A pointer to a function that can send and receive data via the SPI peripheral
  * @param led_set A pointer to a function that sets the state of a LED
@@ -50,7 +57,12 @@ typedef struct {
     system_reset_callback_t system_reset;
     interrupt_critical_section_enter_t cs_enter;
     interrupt_critical_section_exit_t cs_exit;
+    timebase_clock_get_callback_t clock_get;
+    timebase_clock_set_alarm_callback_t clock_set_alarm;
+    timebase_profiler_clock_get_callback_t profiler_clock_get;
+    idle_sleep_callback_t sleep;
     can_comm_transmit_callback_t can_send;
+    can_comm_timestamp_get_callback_t can_timestamp_get;
     bms_manager_send_callback_t spi_send;
     bms_manager_send_receive_callback_t spi_send_receive;
     led_set_state_callback_t led_set;
@@ -15,6 +15,7 @@
 #include "cellboard-def.h"
 
 #include "bms_network.h"
+#include "can-comm.h"
 
 // TODO: Refactor, change comments with a better explanation
 
@@ -22,6 +23,19 @@
 #define TEMP_MIN_C (-10.f)
 #define TEMP_MAX_C (60.f)
 
+/** @brief Number of cells temperatures sent in a single CAN payload */
+#define TEMP_CAN_GROUP_SIZE (4U)
+#define TEMP_CAN_GROUP_COUNT ((CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT) / (TEMP_CAN_GROUP_SIZE))
+
+/**
+ * @brief Minimum variation of a cell temperature in °C that causes the
+ * transmission of its group when the adaptive telemetry is enabled
+ */
+#define TEMP_DEADBAND_C (0.5f)
+
+/** @brief Maximum time in ms between two transmissions of the same group */
+#define TEMP_REFRESH_MS (1000U)
+
 /**
  * @brief Minimum and maximum limit for the temperature voltages in V
  *
@@ -102,6 +116,11 @@ typedef enum {
  * @param temp_can_payload The canlib payload used to send the cells temperatures data via CAN
  * @param discharge_temp_can_payload The canlib payload used to send the discharge resistors temperature data via CAN
  * @param offset An offset used when the canlib payload is sent
+ * @param sent_count The number of cells temperatures payloads sent
+ * @param saved_count The number of payloads not sent because nothing changed
+ * @param sent_temperatures The last cells temperatures sent via CAN in °C
+ * @param sent_time The time of the last transmission of each group in ms
+ * @param sent_groups Bit flag of the groups that were sent at least once
  */
 typedef struct {
     temp_set_mux_address_callback_t set_address;
@@ -115,6 +134,14 @@ typedef struct {
     bms_cellboard_cells_temperature_converted_t temp_can_payload;
     bms_cellboard_discharge_temperature_converted_t discharge_temp_can_payload;
     size_t offset;
+    uint32_t sent_count;
+    uint32_t saved_count;
+
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    cells_temp_t sent_temperatures;
+    milliseconds_t sent_time[TEMP_CAN_GROUP_COUNT];
+    bit_flag32_t sent_groups;
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
 } _TempHandler;
 
 
@@ -271,12 +298,32 @@ TempReturnCode temp_dump_values(
 /**
  * @brief Get a pointer to the CAN payload of the cells temperatures
  *
+ * @details Each call returns the next group of TEMP_CAN_GROUP_SIZE temperatures
+ * @details With the adaptive telemetry only the groups where a temperature changed
+ * more than TEMP_DEADBAND_C or that were not sent for TEMP_REFRESH_MS are returned
+ *
  * @param byte_size[out] A pointer where the size of the payload in bytes is stored (can be NULL)
  *
  * @return bms_cellboard_cells_temperature_converted_t* A pointer to the payload
+ * or NULL if there is nothing to send
  */
 bms_cellboard_cells_temperature_converted_t * temp_get_cells_temp_canlib_payload(size_t * const byte_size);
 
+/**
+ * @brief Get the number of cells temperatures payloads sent via CAN
+ *
+ * @return uint32_t The number of payloads sent
+ */
+uint32_t temp_get_sent_frame_count(void);
+
+/**
+ * @brief Get the number of cells temperatures payloads that were not sent
+ * because no value changed more than the deadband
+ *
+ * @return uint32_t The number of payloads saved
+ */
+uint32_t temp_get_saved_frame_count(void);
+
 /**
  * @brief Get a pointer to the CAN payload of the discharge resistors temperature
  *
@@ -296,6 +343,8 @@ bms_cellboard_discharge_temperature_converted_t * temp_get_discharge_temp_canlib
 #define temp_get_values() (NULL)
 #define temp_dump_values(out, start, size) (TEMP_OK)
 #define temp_get_cells_temp_canlib_payload(byte_size) (NULL)
+#define temp_get_sent_frame_count() (0U)
+#define temp_get_saved_frame_count() (0U)
 #define temp_get_discharge_temp_canlib_payload(byte_size) (NULL)
 
 #endif // CONF_TEMPERATURE_MODULE_ENABLE
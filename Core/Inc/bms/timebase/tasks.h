@@ -19,11 +19,33 @@
 #include "cellboard-conf.h"
 #include "cellboard-def.h"
 
+#include "bms_network.h"
 #include "bms-monitor-fsm.h"
+#include "can-comm.h"
+#include "volt.h"
+#include "temp.h"
 
 /**@brief Total number of tasks */
 #define TASKS_COUNT (TASKS_ID_COUNT)
 
+/**
+ * @brief Limits of the interval that can be set at runtime in ms
+ *
+ * @details The minimum limits the bus load of the telemetry tasks
+ */
+#define TASKS_INTERVAL_MIN_MS (10U)
+#define TASKS_INTERVAL_MAX_MS (10000U)
+
+/**
+ * @brief The periodic transmission of the cells voltages is not needed when
+ * the payloads are published as soon as the voltages are read
+ */
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+#define TASKS_SEND_VOLTAGES_ENABLED (false)
+#else  // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+#define TASKS_SEND_VOLTAGES_ENABLED (true)
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
 /**
  * @brief List of tasks parameters
  *
@@ -38,23 +60,66 @@
  * @param name The name associated with the task (have to be unique)
  * @param start The first moment when the task is executed (in ticks)
  * @param interval How often the task should run
+ * @param priority The priority class of the task (HIGH or LOW, see TasksPriority)
+ * @param policy What to do when the task falls behind its schedule (SKIP or CATCH_UP, see TasksPolicy)
  * @param exec A pointer to the task function callback
  * @param enabled A boolean indicating if the task is enabled or not
  */
 #define TASKS_X_LIST \
-    TASKS_X(SEND_STATUS, true, 0U, BMS_CELLBOARD_STATUS_CYCLE_TIME_MS, _tasks_send_status) \
-    TASKS_X(SEND_VERSION, true, 0U, BMS_CELLBOARD_VERSION_CYCLE_TIME_MS, _tasks_send_version) \
-    TASKS_X(SEND_ERROR, false, 0U, BMS_CELLBOARD_ERROR_CYCLE_TIME_MS, _tasks_send_errors) \
-    TASKS_X(SEND_VOLTAGES, true, 50U, BMS_CELLBOARD_CELLS_VOLTAGE_CYCLE_TIME_MS, _tasks_send_voltages) \
-    TASKS_X(SEND_TEMPERATURES, true, 50U, BMS_CELLBOARD_CELLS_TEMPERATURE_CYCLE_TIME_MS, _tasks_send_temperatures) \
-    TASKS_X(SEND_DISCHARGE_TEMPERATURES, true, 50U, BMS_CELLBOARD_DISCHARGE_TEMPERATURE_CYCLE_TIME_MS, _tasks_send_discharge_temperatures) \
-    TASKS_X(SEND_BALANCING_STATUS, true, 50U, BMS_CELLBOARD_BALANCING_STATUS_CYCLE_TIME_MS, _tasks_send_balancing_status) \
-    TASKS_X(READ_TEMPERATURES, true, 0U, 10U, _tasks_read_temperatures) \
-    TASKS_X(RUN_BMS_MANAGER, true, 0U, 2U, _tasks_run_bms_manager)
+    TASKS_X(SEND_STATUS, true, 0U, BMS_CELLBOARD_STATUS_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_status) \
+    TASKS_X(SEND_VERSION, true, 0U, BMS_CELLBOARD_VERSION_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_version) \
+    TASKS_X(SEND_ERROR, false, 0U, BMS_CELLBOARD_ERROR_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_errors) \
+    TASKS_X(SEND_VOLTAGES, TASKS_SEND_VOLTAGES_ENABLED, 50U, BMS_CELLBOARD_CELLS_VOLTAGE_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_voltages) \
+    TASKS_X(SEND_TEMPERATURES, true, 50U, BMS_CELLBOARD_CELLS_TEMPERATURE_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_temperatures) \
+    TASKS_X(SEND_DISCHARGE_TEMPERATURES, true, 50U, BMS_CELLBOARD_DISCHARGE_TEMPERATURE_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_discharge_temperatures) \
+    TASKS_X(SEND_BALANCING_STATUS, true, 50U, BMS_CELLBOARD_BALANCING_STATUS_CYCLE_TIME_MS, LOW, SKIP, _tasks_send_balancing_status) \
+    TASKS_X(READ_TEMPERATURES, true, 0U, 10U, HIGH, SKIP, _tasks_read_temperatures) \
+    TASKS_X(RUN_BMS_MANAGER, true, 0U, 2U, HIGH, SKIP, _tasks_run_bms_manager)
+
+/**
+ * @brief List of the time slots of the telemetry tasks
+ *
+ * @attention !!! DO NOT USE THIS MACRO OUTSIDE OF THIS FILE !!!
+ *
+ * @details Each cellboard sends the messages of a task inside its own slot,
+ * the start of the task is delayed by the phase plus the cellboard identifier
+ * times the slot width so that the cellboards do not all send the same
+ * message in the same tick
+ *
+ * @details The phases are different for each message that is sent with the
+ * same slot width, so that the messages of the same cellboard are spread
+ * inside its slot too
+ *
+ * @attention The phase must be inside the slot and the slots of all the
+ * cellboards must fit in the interval of the task, otherwise the last
+ * cellboards overlap with the next period of the first ones, this is checked
+ * at compile time with the default intervals
+ *
+ * @details When the interval of a task is changed at runtime the phase and
+ * the slot are scaled by the ratio between the new and the default interval
+ *
+ * @param name The name of the task
+ * @param phase The offset of the message inside the slot in ms
+ * @param slot The width of the slot of a single cellboard in ms
+ */
+#define TASKS_TDMA_X_LIST \
+    TASKS_TDMA_X(SEND_STATUS, 1U, 160U) \
+    TASKS_TDMA_X(SEND_VERSION, 5U, 160U) \
+    TASKS_TDMA_X(SEND_ERROR, 3U, 32U) \
+    TASKS_TDMA_X(SEND_VOLTAGES, 0U, 7U) \
+    TASKS_TDMA_X(SEND_TEMPERATURES, 4U, 7U) \
+    TASKS_TDMA_X(SEND_DISCHARGE_TEMPERATURES, 2U, 32U) \
+    TASKS_TDMA_X(SEND_BALANCING_STATUS, 6U, 32U)
 
 /** @brief Convert a task name to the corresponding TasksId name */
 #define TASKS_NAME_TO_ID(NAME) (TASKS_ID_##NAME)
 
+/** @brief Convert a priority name to the corresponding TasksPriority value */
+#define TASKS_NAME_TO_PRIORITY(NAME) (TASKS_PRIORITY_##NAME)
+
+/** @brief Convert a policy name to the corresponding TasksPolicy value */
+#define TASKS_NAME_TO_POLICY(NAME) (TASKS_POLICY_##NAME)
+
 /** @brief Type definition for a function that excecutes a single task */
 typedef void (* tasks_callback)(void);
 
@@ -63,19 +128,49 @@ typedef void (* tasks_callback)(void);
  *
  * @details
  *     - TASKS_OK the function executed succesfully
+ *     - TASKS_INVALID_INTERVAL the interval is outside of the allowed limits
  */
 typedef enum {
     TASKS_INVALID_ID,
-    TASKS_OK
+    TASKS_OK,
+    TASKS_INVALID_INTERVAL
 } TasksReturnCode;
 
+/**
+ * @brief Priority class of a task
+ *
+ * @details Tasks with higher priority are always executed first, the others
+ * are executed within a limited budget and can be deferred to the next routine pass
+ *     - TASKS_PRIORITY_HIGH safety-critical tasks (e.g. data acquisition) that are never deferred
+ *     - TASKS_PRIORITY_LOW tasks that can be deferred (e.g. telemetry)
+ */
+typedef enum {
+    TASKS_PRIORITY_HIGH,
+    TASKS_PRIORITY_LOW,
+
+    TASKS_PRIORITY_COUNT
+} TasksPriority;
+
+/**
+ * @brief Policy used when a task falls behind its schedule
+ *
+ * @details A task is behind its schedule when, after its execution, one or more
+ * of its following deadlines have already elapsed
+ *     - TASKS_POLICY_SKIP the elapsed deadlines are skipped and the task runs at the next one
+ *     - TASKS_POLICY_CATCH_UP the task is executed once for each elapsed deadline
+ */
+typedef enum {
+    TASKS_POLICY_SKIP,
+    TASKS_POLICY_CATCH_UP
+} TasksPolicy;
+
 /**
  * @brief Enumeration of tasks
  *
  * @details This enum is mainly used to get the total number of tasks at compile time
  * but can also be used to get a specific tasks given a name in the format TASKS_ID_[NAME]
  */
-#define TASKS_X(NAME, ENABLED, START, INTERVAL, EXEC) TASKS_ID_##NAME,
+#define TASKS_X(NAME, ENABLED, START, INTERVAL, PRIORITY, POLICY, EXEC) TASKS_ID_##NAME,
 typedef enum {
     TASKS_X_LIST
     TASKS_ID_COUNT
@@ -91,6 +186,8 @@ typedef enum {
  * @param id The task identifier
  * @param start The time when the tasks is executed first
  * @param interval The amount of time that must elapsed before the tasks is re-executed
+ * @param priority The priority class of the task
+ * @param policy What to do when the task falls behind its schedule
  * @param exec A pointer to the task callback
  * @param enabled A boolean indicating if the task is enabled
  */
@@ -98,6 +195,8 @@ typedef struct {
     TasksId id;
     ticks_t start;
     ticks_t interval;
+    TasksPriority priority;
+    TasksPolicy policy;
     tasks_callback exec;
     bool enabled;
 } Task;
@@ -108,10 +207,12 @@ typedef struct {
  * @attention This struct should not be used outside of this module
  *
  * @param fsm_event Event used to start an operation of the BMS monitor
+ * @param resolution The timebase resolution used to convert the intervals
  * @param tasks List of tasks
  */
 typedef struct {
     bms_monitor_fsm_event_data_t fsm_event;
+    milliseconds_t resolution;
 
     Task tasks[TASKS_COUNT];
 } _TasksHandler;
@@ -121,6 +222,9 @@ typedef struct {
 /**
  * @brief Initialize the tasks module
  *
+ * @attention With the TDMA slots the start of the telemetry tasks depends on
+ * the cellboard identifier so the identity module has to be initialized first
+ *
  * @param resolution The timebase resolution
  *
  * @return TasksReturnCode
@@ -185,6 +289,42 @@ TasksReturnCode tasks_set_enable(const TasksId id, const bool enabled);
  */
 bool tasks_is_enabled(const TasksId id);
 
+/**
+ * @brief Change the interval of a single task
+ *
+ * @details The task is rescheduled inside the timebase so that a shorter
+ * interval takes effect immediately
+ * @details With the TDMA slots the time slot of the cellboard is scaled with
+ * the interval, see TASKS_TDMA_X_LIST
+ *
+ * @param id The task identifier
+ * @param interval The new interval in ms
+ *
+ * @return TasksReturnCode
+ *     - TASKS_INVALID_ID the given identifier does not exists
+ *     - TASKS_INVALID_INTERVAL the interval is not between TASKS_INTERVAL_MIN_MS and TASKS_INTERVAL_MAX_MS
+ *     - TASKS_OK otherwise
+ */
+TasksReturnCode tasks_set_interval(const TasksId id, const milliseconds_t interval);
+
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+/**
+ * @brief Send the next group of cells voltages that was updated since its last transmission
+ *
+ * @details This function should be called right after the voltages are read
+ * from the LTCs so that the payloads carry the most recent data
+ * @details Only one group at a time can wait to be sent, the remaining ones
+ * are sent by the following calls
+ */
+void tasks_publish_voltages(void);
+
+#else  // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+#define tasks_publish_voltages() CELLBOARD_NOPE()
+
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
 #else  // CONF_TASKS_MODULE_ENABLE
 
 #define tasks_init(resolution) (TASKS_OK)
@@ -192,6 +332,8 @@ bool tasks_is_enabled(const TasksId id);
 #define tasks_get_start(id) (0U)
 #define tasks_get_interval(id) (0U)
 #define tasks_get_callback(id) (NULL)
+#define tasks_set_interval(id, interval) (TASKS_OK)
+#define tasks_publish_voltages() CELLBOARD_NOPE()
 
 #endif // CONF_TASKS_MODULE_ENABLE
 
@@ -41,9 +41,86 @@
  */
 #define TIMEBASE_TICKS_TO_MS(T, RES) ((T) * (RES))
 
+/** @brief Default number of ms that represents a single tick */
+#define TIMEBASE_RESOLUTION_MS (1U)
+
+/** @brief Frequency of the free-running counter used as clock in tickless mode */
+#define TIMEBASE_CLOCK_FREQUENCY_HZ (1000000U)
+
+/**
+ * @brief Maximum amount of time between two consecutive alarms in tickless mode
+ *
+ * @details This value has to be much lower than the period of the free-running
+ * counter otherwise the alarm could be ambiguous
+ */
+#define TIMEBASE_CLOCK_MAX_IDLE_MS (1000U)
+
+/**
+ * @brief Frequency of the clock used by the profiler to measure the execution time of the tasks
+ *
+ * @details On the target the CPU cycle counter is used as clock
+ */
+#define TIMEBASE_PROFILER_CLOCK_FREQUENCY_HZ (170000000U)
+
+/**
+ * @brief Convert the profiler clock counts to microseconds
+ *
+ * @param C The number of counts to convert
+ *
+ * @return uint32_t The corresponding amount of microseconds
+ */
+#define TIMEBASE_PROFILER_COUNTS_TO_US(C) ((C) / (TIMEBASE_PROFILER_CLOCK_FREQUENCY_HZ / 1000000U))
+
+/**
+ * @brief Maximum number of elapsed deadlines that a task with the catch-up policy can recover
+ *
+ * @details If a task falls behind by more deadlines than this value they are
+ * skipped regardless of its policy to avoid long bursts of executions
+ */
+#define TIMEBASE_CATCH_UP_MAX_RELEASES (4U)
+
+/**
+ * @brief Maximum number of tasks, other than the high priority ones, executed in a single routine pass
+ *
+ * @details The remaining tasks are deferred to the following passes, so that
+ * a burst of telemetry does not delay the next high priority tasks and the watchdogs
+ */
+#define TIMEBASE_ROUTINE_BUDGET (2U)
+
+/**
+ * @brief Number of bins of the release jitter histogram of each task
+ *
+ * @details The first bin counts the executions released on time, the n-th bin
+ * counts the executions delayed by [2^(n-1), 2^n) ticks and the last one
+ * counts all the remaining executions
+ */
+#define TIMEBASE_JITTER_BIN_COUNT (8U)
+
 /** @brief Maximum number of watchdogs that can be handled simultaneously */
 #define TIMEBASE_RUNNING_WATCHDOG_COUNT (24U)
 
+/**
+ * @brief Number of slots of the tasks timing wheel
+ *
+ * @attention This value must be a power of two
+ *
+ * @details Tasks whose deadline is more than one revolution away are kept
+ * in their slot and are skipped until the right revolution is reached
+ */
+#define TIMEBASE_WHEEL_SLOT_COUNT (64U)
+
+/** @brief Mask used to get the timing wheel slot from a number of ticks */
+#define TIMEBASE_WHEEL_SLOT_MASK (TIMEBASE_WHEEL_SLOT_COUNT - 1U)
+
+/**
+ * @brief Get the timing wheel slot where a task with the given deadline is stored
+ *
+ * @param T The deadline of the task in ticks
+ *
+ * @return size_t The index of the slot
+ */
+#define TIMEBASE_WHEEL_SLOT(T) ((T) & TIMEBASE_WHEEL_SLOT_MASK)
+
 /**
  * @brief Return code for the timebase module functions
  *
@@ -64,6 +141,71 @@ typedef enum {
     TIMEBASE_WATCHDOG_UNAVAILABLE
 } TimebaseReturnCode;
 
+/**
+ * @brief Type definition for a function that reads the value of a free-running counter
+ *
+ * @details The counter should run at TIMEBASE_CLOCK_FREQUENCY_HZ and wrap around
+ * when it reaches its maximum 32-bit value
+ *
+ * @return uint32_t The current value of the counter
+ */
+typedef uint32_t (* timebase_clock_get_callback_t)(void);
+
+/**
+ * @brief Type definition for a function that sets an alarm on the free-running counter
+ *
+ * @details The alarm should wake up the microcontroller when the counter reaches
+ * the given value, if the value has already been reached the alarm should trigger immediately
+ *
+ * @param counter The value of the counter when the alarm should trigger
+ */
+typedef void (* timebase_clock_set_alarm_callback_t)(const uint32_t counter);
+
+/**
+ * @brief Type definition for a function that reads the clock used by the profiler
+ *
+ * @details The clock should run at TIMEBASE_PROFILER_CLOCK_FREQUENCY_HZ and wrap around
+ * when it reaches its maximum 32-bit value
+ *
+ * @return uint32_t The current value of the clock
+ */
+typedef uint32_t (* timebase_profiler_clock_get_callback_t)(void);
+
+/**
+ * @brief Execution time statistics of a single task
+ *
+ * @details The times are expressed in counts of the profiler clock
+ *
+ * @param count The number of times the task was executed
+ * @param overruns The number of executions that lasted longer than the task interval
+ * @param min The minimum execution time
+ * @param max The maximum execution time
+ * @param total The sum of all the execution times
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t overruns;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} TimebaseTaskProfile;
+
+/**
+ * @brief Release jitter statistics of a single task
+ *
+ * @details The jitter is the delay between the deadline of the task and the
+ * tick in which it is actually executed
+ *
+ * @param bins The histogram of the delays (see TIMEBASE_JITTER_BIN_COUNT)
+ * @param max The maximum delay in ticks
+ * @param skipped The number of deadlines that were skipped because the task fell behind
+ */
+typedef struct {
+    uint32_t bins[TIMEBASE_JITTER_BIN_COUNT];
+    ticks_t max;
+    uint32_t skipped;
+} TimebaseTaskJitter;
+
 /**
  * @brief Definition of a scheduled task that has to be executed at a certain time
  *
@@ -86,6 +228,38 @@ typedef struct {
     Watchdog * watchdog;
 } TimebaseScheduledWatchdog;
 
+/**
+ * @brief Definition of the heap of the running watchdogs
+ *
+ * @details Each registered watchdog stores its own position inside the heap
+ * so that it can be updated or removed without searching for it
+ *
+ * @param size The number of registered watchdogs
+ * @param data The scheduled watchdogs ordered as a binary min-heap
+ */
+typedef struct {
+    size_t size;
+    TimebaseScheduledWatchdog data[TIMEBASE_RUNNING_WATCHDOG_COUNT];
+} TimebaseWatchdogHeap;
+
+/**
+ * @brief Definition of the timing wheel used to dispatch the tasks
+ *
+ * @details Each slot is a bitmask where the n-th bit is set if the task with
+ * identifier n has a deadline that falls inside that slot
+ * Tasks are dispatched in order of deadline and, for equal deadlines, in the
+ * same order in which they are defined inside the TASKS_X_LIST
+ *
+ * @param t The next tick that has to be processed by the wheel
+ * @param deadline The time in which each task should be executed
+ * @param slots The bitmasks of the scheduled tasks for each slot
+ */
+typedef struct {
+    ticks_t t;
+    ticks_t deadline[TASKS_COUNT];
+    bit_flag32_t slots[TIMEBASE_WHEEL_SLOT_COUNT];
+} TimebaseTasksWheel;
+
 /**
  * @brief Type definition for the timebase handler structure
  *
@@ -94,16 +268,38 @@ typedef struct {
  * @param enabled True if the timebase is running, false otherwise
  * @param resolution Number of ms that represent one tick
  * @param t The current number of ticks
- * @param scheduled_tasks The heap of scheduled tasks that has to be executed
+ * @param clock_get A pointer to the function that reads the free-running counter (NULL if not in tickless mode)
+ * @param clock_set_alarm A pointer to the function that sets the alarm on the free-running counter
+ * @param counter The value of the free-running counter that corresponds to the current tick
+ * @param counts_per_tick The number of counter increments that represent one tick
+ * @param scheduled_tasks The wheels (or the heaps) of scheduled tasks that has to be executed, one for each priority
  * @param scheduled_watchdogs The heap of scheduled watchdogs that are currently running
+ * @param jitter The release jitter statistics of each task
+ * @param profiler_clock_get A pointer to the function that reads the profiler clock (NULL if not profiling)
+ * @param profiles The execution time statistics of each task
  */
 typedef struct {
     bool enabled;
     milliseconds_t resolution;
     _VOLATILE ticks_t t;
 
-    MinHeap(TimebaseScheduledTask, TASKS_COUNT) scheduled_tasks;
-    MinHeap(TimebaseScheduledWatchdog, TIMEBASE_RUNNING_WATCHDOG_COUNT) scheduled_watchdogs;
+    timebase_clock_get_callback_t clock_get;
+    timebase_clock_set_alarm_callback_t clock_set_alarm;
+    uint32_t counter;
+    uint32_t counts_per_tick;
+
+#ifdef CONF_TIMEBASE_WHEEL_ENABLE
+    TimebaseTasksWheel scheduled_tasks[TASKS_PRIORITY_COUNT];
+#else  // CONF_TIMEBASE_WHEEL_ENABLE
+    MinHeap(TimebaseScheduledTask, TASKS_COUNT) scheduled_tasks[TASKS_PRIORITY_COUNT];
+#endif // CONF_TIMEBASE_WHEEL_ENABLE
+    TimebaseWatchdogHeap scheduled_watchdogs;
+    TimebaseTaskJitter jitter[TASKS_COUNT];
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+    timebase_profiler_clock_get_callback_t profiler_clock_get;
+    TimebaseTaskProfile profiles[TASKS_COUNT];
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
 } _TimebaseHandler;
 
 #ifdef CONF_TIMEBASE_MODULE_ENABLE
@@ -111,13 +307,26 @@ typedef struct {
 /**
  * @brief Initialize the timebase handler
  *
+ * @details If the clock callbacks are given the timebase runs in tickless mode,
+ * where the current time is read from a free-running counter and an alarm is set
+ * for the earliest deadline of the tasks and watchdogs, otherwise the time
+ * is incremented by calling the timebase_inc_tick function periodically
+ *
+ * @attention Both the clock callbacks must be either NULL or not NULL
+ *
  * @param resolution The amount of time that represent one tick (in ms)
+ * @param clock_get A pointer to the function that reads the free-running counter (can be NULL)
+ * @param clock_set_alarm A pointer to the function that sets the alarm on the free-running counter (can be NULL)
  *
  * @return TimebaseReturnCode
- *     - TIMEBASE_NULL_POINTER if a tasks is not implemented
+ *     - TIMEBASE_NULL_POINTER if only one of the clock callbacks is NULL
  *     - TIMEBASE_OK otherwise
  */
-TimebaseReturnCode timebase_init(const milliseconds_t resolution_ms);
+TimebaseReturnCode timebase_init(
+    const milliseconds_t resolution_ms,
+    const timebase_clock_get_callback_t clock_get,
+    const timebase_clock_set_alarm_callback_t clock_set_alarm
+);
 
 /**
  * @brief Enable or disable the timebase
@@ -128,6 +337,8 @@ void timebase_set_enable(const bool enabled);
 
 /**
  * @brief Increment the internal timebase by one tick
+ *
+ * @attention This function should not be used in tickless mode
  * 
  * @return TimebaseReturnCode
  *     - TIMEBASE_DISABLED if the timebase is disabled
@@ -156,6 +367,16 @@ milliseconds_t timebase_get_time(void);
  */
 milliseconds_t timebase_get_resolution(void);
 
+/**
+ * @brief Get the earliest time in which a task or a watchdog has to be handled
+ *
+ * @details The returned time is never later than TIMEBASE_CLOCK_MAX_IDLE_MS
+ * from the current time
+ *
+ * @return ticks_t The earliest deadline in ticks
+ */
+ticks_t timebase_get_next_deadline(void);
+
 /**
  * @brief Register a watchdog into the timebase
  *
@@ -199,41 +420,130 @@ bool timebase_is_registered_watchdog(Watchdog * const watchdog);
 /**
  * @brief Update the registered watchdog
  *
- * @attention During the update process the watchdog is unregistered and than registered again
- * if the function returns TIMEBASE_WATCHDOG_UNAVAILABLE that means that the watchdog was
- * unregistered but cannot be registered back (i.e. is not running anymore)
+ * @details The watchdog is moved in place using the position stored inside
+ * its structure, no search is done
  *
  * @param watchdog A pointer to the watchdog
  *
  * @return TimebaseReturnCode
  *     - TIMEBASE_NULL_POINTER if the watchdog is NULL
  *     - TIMEBASE_WATCHDOG_NOT_REGISTERED the watchdog is not registered
- *     - TIMEBASE_WATCHDOG_UNAVAILABLE if the watchdog can't be registered again
  *     - TIMEBASE_OK otherwise
  */
 TimebaseReturnCode timebase_update_watchdog(Watchdog * const watchdog);
 
+/**
+ * @brief Update the schedule of a task after its interval is changed
+ *
+ * @details If the interval is shortened the task is moved so that it is
+ * released no later than one new interval from now, otherwise the current
+ * deadline is kept and the new interval is used from the next release
+ *
+ * @param id The identifier of the task
+ *
+ * @return TimebaseReturnCode
+ *     - TIMEBASE_NULL_POINTER if the task does not exist
+ *     - TIMEBASE_OK otherwise
+ */
+TimebaseReturnCode timebase_reschedule_task(const TasksId id);
+
 /**
  * @brief Routine that checks which functions shuold run during this
  *
+ * @details The high priority tasks are executed first, then the watchdogs are
+ * checked and at last the other tasks are executed until the TIMEBASE_ROUTINE_BUDGET
+ * is exhausted, the tasks left are deferred to the next call of this function
+ *
+ * @details Periodic tasks are rescheduled relative to their previous deadline
+ * so that a late execution does not shift the following ones, if a task falls
+ * behind its schedule the elapsed deadlines are handled according to its policy
+ *
+ * @details In tickless mode the current time is updated from the clock at the
+ * start of the routine and the alarm is set for the next deadline at the end
+ *
  * @return TimebaseReturnCode
  *     - TIMEBASE_DISABLED if the timebase is disabled
  *     - TIMEBASE_OK otherwise
  */
 TimebaseReturnCode timebase_routine(void);
 
+/**
+ * @brief Get the release jitter statistics of a task
+ *
+ * @param id The identifier of the task
+ *
+ * @return const TimebaseTaskJitter* A pointer to the statistics or NULL if the id is not valid
+ */
+const TimebaseTaskJitter * timebase_get_task_jitter(const TasksId id);
+
+/** @brief Reset the release jitter statistics of all the tasks */
+void timebase_reset_jitter(void);
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+
+/**
+ * @brief Initialize the tasks execution time profiler
+ *
+ * @attention This function has to be called after the timebase initialization
+ *
+ * @param clock_get A pointer to the function that reads the profiler clock
+ *
+ * @return TimebaseReturnCode
+ *     - TIMEBASE_NULL_POINTER if the clock callback is NULL
+ *     - TIMEBASE_OK otherwise
+ */
+TimebaseReturnCode timebase_profiler_init(const timebase_profiler_clock_get_callback_t clock_get);
+
+/** @brief Reset the execution time statistics of all the tasks */
+void timebase_profiler_reset(void);
+
+/**
+ * @brief Get the execution time statistics of a task
+ *
+ * @param id The identifier of the task
+ *
+ * @return const TimebaseTaskProfile* A pointer to the statistics or NULL if the id is not valid
+ */
+const TimebaseTaskProfile * timebase_profiler_get_task(const TasksId id);
+
+/**
+ * @brief Get the mean execution time of a task
+ *
+ * @param id The identifier of the task
+ *
+ * @return uint32_t The mean execution time in profiler clock counts or 0 if the id is not valid
+ */
+uint32_t timebase_profiler_get_mean(const TasksId id);
+
+#else  // CONF_TIMEBASE_PROFILER_ENABLE
+
+#define timebase_profiler_init(clock_get) (TIMEBASE_OK)
+#define timebase_profiler_reset() CELLBOARD_NOPE()
+#define timebase_profiler_get_task(id) (NULL)
+#define timebase_profiler_get_mean(id) (0U)
+
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+
 #else  // CONF_TIMEBASE_MODULE_ENABLE
 
-#define timebase_init(resolution) (TIMEBASE_OK)
+#define timebase_init(resolution, clock_get, clock_set_alarm) (TIMEBASE_OK)
 #define timebase_set_enable() CELLBOARD_NOPE()
 #define timebase_inc_tick() (TIMEBASE_OK)
 #define timebase_get_tick() (0U)
 #define timebase_get_time() (0U)
 #define timebase_get_resolution() (1U) // The default value of 1 is used to avoid 0 division error
+#define timebase_get_next_deadline() (0U)
 #define timebase_regsiter_watchdog(watchdog) (TIMEBASE_OK)
 #define timebase_unregsiter_watchdog(watchdog) (TIMEBASE_OK)
 #define timebase_update_watchdog(watchdog) (TIMEBASE_OK)
+#define timebase_reschedule_task(id) (TIMEBASE_OK)
 #define timebase_routine() (TIMEBASE_OK)
+#define timebase_get_task_jitter(id) (NULL)
+#define timebase_reset_jitter() CELLBOARD_NOPE()
+#define timebase_profiler_init(clock_get) (TIMEBASE_OK)
+#define timebase_profiler_reset() CELLBOARD_NOPE()
+#define timebase_profiler_get_task(id) (NULL)
+#define timebase_profiler_get_mean(id) (0U)
 
 #endif // CONF_TIMEBASE_MODULE_ENABLE
 
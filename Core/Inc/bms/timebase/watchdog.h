@@ -10,6 +10,7 @@
 #define WATCHDOG_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "cellboard-conf.h"
 #include "cellboard-def.h"
@@ -48,12 +49,16 @@ typedef void (* watchdog_timeout_callback)(void);
  * @param timed_out True if the watchdog is running, false otherwise
  * @param timeout The number of ticks that should elapse for the watchdog to time-out
  * @param expire The function that is called when the watchdog times-out
+ * @param slot The position of the watchdog inside the timebase plus one (0 if not registered)
+ *
+ * @attention The slot is handled by the timebase and should not be modified elsewhere
  */
 typedef struct {
     bool running;
     bool timed_out;
     ticks_t timeout;
     watchdog_timeout_callback expire;
+    size_t slot;
 } Watchdog;
 
 #ifdef CONF_WATCHDOG_MODULE_ENABLE
@@ -15,11 +15,55 @@
 #include "cellboard-def.h"
 
 #include "bms_network.h"
+#include "can-comm.h"
 
 /** @brief Minimum and maximum allowed cell voltage in V */
 #define VOLT_MIN_V (2.8f)
 #define VOLT_MAX_V (4.2f)
 
+/** @brief Number of cells voltages sent in a single CAN payload */
+#define VOLT_CAN_GROUP_SIZE (3U)
+#define VOLT_CAN_GROUP_COUNT ((CELLBOARD_SEGMENT_SERIES_COUNT) / (VOLT_CAN_GROUP_SIZE))
+
+/**
+ * @brief Minimum variation of a cell voltage in V that causes the
+ * transmission of its group when the adaptive telemetry is enabled
+ */
+#define VOLT_DEADBAND_V (0.005f)
+
+/** @brief Maximum time in ms between two transmissions of the same group */
+#define VOLT_REFRESH_MS (1000U)
+
+/**
+ * @brief Minimum time in ms between two transmissions of the same group when
+ * the payloads are published as soon as the voltages are read
+ *
+ * @details The bus load is the same as the one of the periodic transmission
+ */
+#define VOLT_PUBLISH_INTERVAL_MS ((VOLT_CAN_GROUP_COUNT) * (BMS_CELLBOARD_CELLS_VOLTAGE_CYCLE_TIME_MS))
+
+/** @brief Conversion from the raw value read from the LTC (100 uV per unit) to V */
+#define VOLT_RAW_TO_VOLT(value) ((value) * 0.0001f)
+#define VOLT_VOLT_TO_RAW(value) ((raw_volt_t)((value) * 10000.f + 0.5f))
+
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
+/**
+ * @brief Scaling of the cells voltages inside the raw canlib payload
+ *
+ * @details The voltages from VOLT_CAN_RAW_MIN to VOLT_CAN_RAW_MIN + VOLT_CAN_RAW_RANGE
+ * are mapped from 0 to VOLT_CAN_RAW_MAX and truncated, the limits are taken from
+ * the range and size of the voltage signals of the canlib message and converted
+ * in LTC units so that the scaling is done with integers only
+ * @details The integer scaling is compared with the canlib conversion when the
+ * module is initialized and it is used only if they give the same values
+ */
+#define VOLT_CAN_RAW_MIN ((uint32_t)((BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MIN) * 10000.0 + 0.5))
+#define VOLT_CAN_RAW_RANGE ((uint32_t)(((BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MAX) - (BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MIN)) * 10000.0 + 0.5))
+#define VOLT_CAN_RAW_MAX ((1U << (BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_BIT_SIZE)) - 1U)
+
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 /**
  * @brief Type definition for the array of cells voltages
  *
@@ -28,6 +72,19 @@
  * the array length
  */
 typedef volt_t cells_volt_t[CELLBOARD_SEGMENT_SERIES_COUNT];
+typedef raw_volt_t cells_raw_volt_t[CELLBOARD_SEGMENT_SERIES_COUNT];
+
+/**
+ * @brief Type definition for the canlib payload of the cells voltages
+ *
+ * @details With the raw payload the structure is filled with the values
+ * already scaled and it is only packed before the transmission
+ */
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+typedef bms_cellboard_cells_voltage_t volt_canlib_payload_t;
+#else  // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+typedef bms_cellboard_cells_voltage_converted_t volt_canlib_payload_t;
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
 
 /**
  * @brief Return code for the voltage module functions
@@ -47,12 +104,39 @@ typedef enum {
  * @brief Type definition for the voltages handler structure
  *
  * @param voltages The array of cells voltages in V
+ * @param raw_voltages The array of cells voltages as read from the LTC
  * @param voltages_can_payload The canlib payload of the cells voltages
+ * @param raw_scaling_exact True if the integer scaling gives the same values of the canlib conversion
+ * @param offset The index of the first cell of the next group to send
+ * @param sent_count The number of payloads sent
+ * @param saved_count The number of payloads not sent because nothing changed
+ * @param sent_time The time of the last transmission of each group in ms
+ * @param sent_groups Bit flag of the groups that were sent at least once
+ * @param sent_voltages The last voltages sent via CAN in V
+ * @param updated_groups Bit flag of the groups updated since their last transmission
  */
 typedef struct {
     cells_volt_t voltages;
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    cells_raw_volt_t raw_voltages;
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
 
-    bms_cellboard_cells_voltage_converted_t voltages_can_payload;
+    volt_canlib_payload_t voltages_can_payload;
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    bool raw_scaling_exact;
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    size_t offset;
+    uint32_t sent_count;
+    uint32_t saved_count;
+    milliseconds_t sent_time[VOLT_CAN_GROUP_COUNT];
+    bit_flag32_t sent_groups;
+
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    cells_volt_t sent_voltages;
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+    bit_flag32_t updated_groups;
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
 } _VoltHandler;
 
 
@@ -78,6 +162,25 @@ VoltReturnCode volt_init(void);
  */
 VoltReturnCode volt_update_value(const size_t index, const volt_t value);
 
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
+/**
+ * @brief Update a single voltage value with the raw value read from the LTC
+ *
+ * @details The raw value is kept to fill the canlib payload without
+ * floating point conversions
+ *
+ * @param index The index of the value to update
+ * @param value The new raw value (100 uV per unit)
+ *
+ * @return VoltReturnCode
+ *     - VOLT_OUT_OF_BOUNDS if the index is greater than the total number of values
+ *     - VOLT_OK otherwise
+ */
+VoltReturnCode volt_update_raw_value(const size_t index, const raw_volt_t value);
+
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 /**
  * @brief Update multiple voltage values
  *
@@ -172,21 +275,62 @@ VoltReturnCode volt_dump_values(
 /**
  * @brief Get a pointer to the CAN payload of the cells voltages
  *
+ * @details Each call returns the next group of VOLT_CAN_GROUP_SIZE cells
+ * @details With the adaptive telemetry only the groups where a voltage changed
+ * more than VOLT_DEADBAND_V or that were not sent for VOLT_REFRESH_MS are returned
+ *
  * @param byte_size[out] A pointer where the size of the payload in bytes is stored (can be NULL)
  *
- * @return bms_cellboard_cells_voltage_converted_t* A pointer to the payload
+ * @return volt_canlib_payload_t* A pointer to the payload
+ * or NULL if there is nothing to send
+ */
+volt_canlib_payload_t * volt_get_canlib_payload(size_t * byte_size);
+
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+/**
+ * @brief Get a pointer to the CAN payload of the next group of cells voltages
+ * that was updated since its last transmission
+ *
+ * @details A group is not sent again before VOLT_PUBLISH_INTERVAL_MS and, with
+ * the adaptive telemetry, if no voltage changed more than VOLT_DEADBAND_V
+ *
+ * @param byte_size[out] A pointer where the size of the payload in bytes is stored (can be NULL)
+ *
+ * @return volt_canlib_payload_t* A pointer to the payload
+ * or NULL if there is nothing to send
+ */
+volt_canlib_payload_t * volt_get_updated_canlib_payload(size_t * const byte_size);
+
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+/**
+ * @brief Get the number of cells voltages payloads sent via CAN
+ *
+ * @return uint32_t The number of payloads sent
+ */
+uint32_t volt_get_sent_frame_count(void);
+
+/**
+ * @brief Get the number of cells voltages payloads that were not sent
+ * because no value changed more than the deadband
+ *
+ * @return uint32_t The number of payloads saved
  */
-bms_cellboard_cells_voltage_converted_t * volt_get_canlib_payload(size_t * byte_size);
+uint32_t volt_get_saved_frame_count(void);
 
 #else  // CONF_VOLTAGE_MODULE_ENABLE
 
 #define volt_init() (VOLT_OK)
 #define volt_update_value(index, value) (VOLT_OK)
+#define volt_update_raw_value(index, value) (VOLT_OK)
 #define volt_update_values(index, value, size) (VOLT_OK)
 #define volt_get_values() (NULL)
 #define volt_select_values(target) (0U)
 #define volt_dump_values(out, start, size) (VOLT_OK)
 #define volt_get_canlib_payload(byte_size) (NULL)
+#define volt_get_sent_frame_count() (0U)
+#define volt_get_saved_frame_count() (0U)
 
 #endif  // CONF_VOLTAGE_MODULE_ENABLE
 
@@ -40,6 +40,44 @@
 #define CONF_BMS_MANAGER_MODULE_ENABLE
 #define CONF_LED_MODULE_ENABLE
 #define CONF_ERROR_MODULE_ENABLE
+// #define CONF_IDLE_MODULE_ENABLE
+
+/** @} */
+
+/*** ######################### FEATURES SELECTION ######################## ***/
+
+/**
+ * @defgroup features
+ * @brief Enable or disable optional features of the internal modules
+ * {@
+ */
+
+// Dispatch the timebase tasks with a timing wheel instead of a min-heap
+#define CONF_TIMEBASE_WHEEL_ENABLE
+
+// Run the timebase from a free-running counter instead of a periodic interrupt
+// #define CONF_TIMEBASE_TICKLESS_ENABLE
+
+// Measure the execution time of the timebase tasks
+// #define CONF_TIMEBASE_PROFILER_ENABLE
+
+// Shift the start of the telemetry tasks of each cellboard in its own time slot so that the cellboards do not send at the same time
+// #define CONF_TASKS_TDMA_ENABLE
+
+// Send the cells voltages and temperatures only when they change more than a deadband
+// #define CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+// Send the cells voltages right after they are read instead of periodically
+// #define CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+// Fill the raw canlib payloads of the cells voltages and balancing status without floating point conversions
+// #define CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
+// Refill the CAN transmission FIFO from the transmission complete interrupt instead of the main loop
+// #define CONF_CAN_COMM_TX_ISR_ENABLE
+
+// Collect the CAN latency, queue and error statistics
+// #define CONF_CAN_COMM_STATS_ENABLE
 
 /** @} */
 
@@ -62,6 +100,7 @@
 // #define CONF_BMS_MANAGER_STRINGS_ENABLE
 // #define CONF_LED_STRINGS_ENABLE
 // #define CONF_ERROR_STRINGS_ENABLE
+// #define CONF_IDLE_STRINGS_ENABLE
 
 /** @} */
 
@@ -72,6 +72,19 @@ CanCommReturnCode can_send(
     const size_t size
 );
 
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Read the timestamp counter of the CAN peripheral
+ *
+ * @details The counter is incremented at every nominal bit time
+ *
+ * @return uint16_t The counter value
+ */
+uint16_t can_get_timestamp(void);
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
@@ -44,6 +44,14 @@ extern TIM_HandleTypeDef htim7;
 #define HTIM_ERROR htim6
 /** @brief Timebase timer definition */
 #define HTIM_TIMEBASE htim7
+/**
+ * @brief Free-running timer used as clock by the timebase in tickless mode
+ *
+ * @details Its interrupt is enabled by the NVIC settings of the CubeMX project
+ * (TIM2_IRQn) so that the alarm can wake the microcontroller from the idle sleep
+ */
+#define HTIM_CLOCK htim2
+#define HTIM_CLOCK_CHANNEL TIM_CHANNEL_1
 
 /* USER CODE END Private defines */
 
@@ -53,6 +61,20 @@ void MX_TIM7_Init(void);
 
 /* USER CODE BEGIN Prototypes */
 
+/**
+ * @brief Get the current value of the free-running clock counter
+ *
+ * @return uint32_t The counter value
+ */
+uint32_t tim_get_clock_counter(void);
+
+/**
+ * @brief Set the alarm of the free-running clock
+ *
+ * @param counter The counter value at which the alarm should trigger
+ */
+void tim_set_clock_alarm(const uint32_t counter);
+
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
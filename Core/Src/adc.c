@@ -23,6 +23,7 @@
 /* USER CODE BEGIN 0 */
 
 #include "temp.h"
+#include "idle.h"
 
 /* USER CODE END 0 */
 
@@ -196,6 +197,8 @@ void adc_temperature_start_conversion(void) {
 
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef * hadc) {
     if (hadc->Instance == HADC_TEMPS.Instance) {
+        idle_notify(IDLE_WAKE_REASON_ADC);
+
         volt_t data[ADC_DMA_CHANNEL_COUNT];
         for (size_t i = 0U; i < ADC_DMA_CHANNEL_COUNT; ++i) {
             data[i] = CELLBOARD_ADC_RAW_VALUE_TO_VOLT(dma_data[i], ADC_VREF, ADC_RESOLUTION);
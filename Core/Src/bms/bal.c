@@ -137,7 +137,7 @@ BalReturnCode bal_resume(void) {
     return BAL_OK;
 }
 
-bms_cellboard_balancing_status_converted_t * bal_get_status_canlib_payload(size_t * const byte_size) {
+bal_status_canlib_payload_t * bal_get_status_canlib_payload(size_t * const byte_size) {
     if (byte_size != NULL)
         *byte_size = sizeof(hbal.status_can_payload);
 
@@ -17,54 +17,603 @@
 #include "bal.h"
 #include "error.h"
 
-#include "canlib_device.h"
 
 #ifdef CONF_CAN_COMM_MODULE_ENABLE
 
 _STATIC _CanCommHandler hcan_comm;
 
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+#define CAN_COMM_TX_TELEMETRY_PAYLOAD RAW
+#else  // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+#define CAN_COMM_TX_TELEMETRY_PAYLOAD CONVERTED
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 /**
- * @brief Get a pointer to the canlib payload handler callback function based on the message index
+ * @brief List of the messages sent by the cellboard
  *
- * @param index The message index
+ * @details Each element is made of the prefix of the canlib macros, the
+ * prefix of the canlib functions and types of the message, a flag that
+ * tells if the serialized frame is kept until the producer of the payload
+ * notifies a change with can_comm_tx_set_dirty and the type of payload
+ * given by the producer (CONVERTED or RAW canlib structure)
+ */
+#define CAN_COMM_TX_X_LIST \
+    CAN_COMM_TX_X(BMS_CELLBOARD_STATUS, bms_cellboard_status, true, CONVERTED) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_VERSION, bms_cellboard_version, true, CONVERTED) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_ERROR, bms_cellboard_error, false, CONVERTED) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_CELLS_VOLTAGE, bms_cellboard_cells_voltage, false, CAN_COMM_TX_TELEMETRY_PAYLOAD) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_CELLS_TEMPERATURE, bms_cellboard_cells_temperature, false, CONVERTED) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_DISCHARGE_TEMPERATURE, bms_cellboard_discharge_temperature, false, CONVERTED) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_BALANCING_STATUS, bms_cellboard_balancing_status, false, CAN_COMM_TX_TELEMETRY_PAYLOAD) \
+    CAN_COMM_TX_X(BMS_CELLBOARD_FLASH_RESPONSE, bms_cellboard_flash_response, false, CONVERTED)
+
+/**
+ * @brief List of the messages received and handled by the cellboard
+ *
+ * @details Each element is made of the prefix of the canlib macros, the
+ * prefix of the canlib functions and types of the message and the function
+ * that handles the converted payload
+ *
+ * @details The position of each message is the index of the hardware filter
+ * that accepts its identifier
+ */
+#define CAN_COMM_RX_X_LIST \
+    CAN_COMM_RX_X(BMS_CELLBOARD_FLASH_REQUEST, bms_cellboard_flash_request, programmer_flash_request_handle) \
+    CAN_COMM_RX_X(BMS_CELLBOARD_FLASH, bms_cellboard_flash, programmer_flash_handle) \
+    CAN_COMM_RX_X(BMS_CELLBOARD_SET_BALANCING_STATUS, bms_cellboard_set_balancing_status, bal_set_balancing_status_handle)
+
+// Serialization of a converted payload, the values are scaled by canlib before packing
+#define CAN_COMM_SERIALIZE_CONVERTED(name) \
+    _STATIC int _can_comm_serialize_##name(const void * const payload, uint8_t * const data) { \
+        name##_t raw; \
+        name##_conversion_to_raw_struct(&raw, (const name##_converted_t *)payload); \
+        return name##_pack(data, &raw, CAN_COMM_TX_FRAME_BYTE_SIZE); \
+    }
+
+// Serialization of a raw payload already scaled by its producer
+#define CAN_COMM_SERIALIZE_RAW(name) \
+    _STATIC int _can_comm_serialize_##name(const void * const payload, uint8_t * const data) { \
+        return name##_pack(data, (const name##_t *)payload, CAN_COMM_TX_FRAME_BYTE_SIZE); \
+    }
+
+// The payload type is expanded before being pasted
+#define CAN_COMM_SERIALIZE(PAYLOAD, name) CAN_COMM_SERIALIZE_##PAYLOAD(name)
+
+// Define a serialization function for each transmitted message
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) CAN_COMM_SERIALIZE(PAYLOAD, name)
+CAN_COMM_TX_X_LIST
+#undef CAN_COMM_TX_X
+
+// Define a deserialization function for each received message that calls its handler
+#define CAN_COMM_RX_X(NAME, name, HANDLE) \
+    _STATIC void _can_comm_deserialize_##name(const uint8_t * const data) { \
+        name##_t raw; \
+        name##_converted_t conv; \
+        if (name##_unpack(&raw, data, CAN_COMM_MAX_PAYLOAD_BYTE_SIZE) < 0) \
+            return; \
+        name##_raw_to_conversion_struct(&conv, &raw); \
+        HANDLE(&conv); \
+    }
+CAN_COMM_RX_X_LIST
+#undef CAN_COMM_RX_X
+
+/** @brief Identifiers of the messages sent or received by the cellboard indexed by the message index */
+_STATIC const can_id_t can_comm_id[CAN_COMM_MESSAGE_COUNT] = {
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) [NAME##_INDEX] = NAME##_FRAME_ID,
+#define CAN_COMM_RX_X(NAME, name, HANDLE) [NAME##_INDEX] = NAME##_FRAME_ID,
+    CAN_COMM_TX_X_LIST
+    CAN_COMM_RX_X_LIST
+#undef CAN_COMM_RX_X
+#undef CAN_COMM_TX_X
+};
+
+/** @brief Serialization functions indexed by the message index, NULL if the message is not sent */
+_STATIC const can_comm_canlib_serialize_callback_t can_comm_serialize[CAN_COMM_MESSAGE_COUNT] = {
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) [NAME##_INDEX] = _can_comm_serialize_##name,
+    CAN_COMM_TX_X_LIST
+#undef CAN_COMM_TX_X
+};
+
+/** @brief Flags indexed by the message index that are true if the serialized frame is kept between additions */
+_STATIC const bool can_comm_tx_cached[CAN_COMM_MESSAGE_COUNT] = {
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) [NAME##_INDEX] = (CACHED),
+    CAN_COMM_TX_X_LIST
+#undef CAN_COMM_TX_X
+};
+
+/** @brief Deserialization functions indexed by the message index, NULL if the message is not handled */
+_STATIC const can_comm_canlib_deserialize_callback_t can_comm_deserialize[CAN_COMM_MESSAGE_COUNT] = {
+#define CAN_COMM_RX_X(NAME, name, HANDLE) [NAME##_INDEX] = _can_comm_deserialize_##name,
+    CAN_COMM_RX_X_LIST
+#undef CAN_COMM_RX_X
+};
+
+/** @brief Indices of the received messages indexed by the hardware filter that accepts them */
+_STATIC const can_index_t can_comm_rx_index[] = {
+#define CAN_COMM_RX_X(NAME, name, HANDLE) NAME##_INDEX,
+    CAN_COMM_RX_X_LIST
+#undef CAN_COMM_RX_X
+};
+
+/** @brief Number of messages received and handled by the cellboard */
+#define CAN_COMM_RX_HANDLED_COUNT (sizeof(can_comm_rx_index) / sizeof(can_comm_rx_index[0]))
+
+/** @brief Indices of the messages sent by the cellboard */
+_STATIC const can_index_t can_comm_tx_index[] = {
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) NAME##_INDEX,
+    CAN_COMM_TX_X_LIST
+#undef CAN_COMM_TX_X
+};
+
+/**
+ * @brief Positions of the messages inside the list of the sent messages
+ *
+ * @attention The messages waiting to be sent are stored in a 32 bit flag so
+ * no more than 32 messages can be sent
+ */
+enum {
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) CAN_COMM_TX_POSITION_##NAME,
+    CAN_COMM_TX_X_LIST
+#undef CAN_COMM_TX_X
+    CAN_COMM_TX_POSITION_COUNT
+};
+_Static_assert(CAN_COMM_TX_POSITION_COUNT == CAN_COMM_TX_SENT_COUNT, "the number of sent messages does not match the list");
+_Static_assert(CAN_COMM_TX_SENT_COUNT <= 32U, "no more than 32 messages can be sent");
+
+/** @brief Positions inside the transmission buffers indexed by the message index, only valid for the sent messages */
+_STATIC const uint8_t can_comm_tx_position[CAN_COMM_MESSAGE_COUNT] = {
+#define CAN_COMM_TX_X(NAME, name, CACHED, PAYLOAD) [NAME##_INDEX] = CAN_COMM_TX_POSITION_##NAME,
+    CAN_COMM_TX_X_LIST
+#undef CAN_COMM_TX_X
+};
+
+/**
+ * @brief Priority of the messages sent by the cellboard
  *
- * @return can_comm_canlib_payload_handle_callback_t A pointer to the callback function
- * or NULL if the index is not valid
+ * @details The priority is the position of the message inside the list of the
+ * sent messages sorted by identifier, so that 0 is the message that wins the
+ * bus arbitration against all the other ones
  */
-can_comm_canlib_payload_handle_callback_t _can_comm_payload_handle(const can_index_t index) {
-    switch (index) {
-        case BMS_CELLBOARD_FLASH_REQUEST_INDEX:
-            return (can_comm_canlib_payload_handle_callback_t)programmer_flash_request_handle;
-        case BMS_CELLBOARD_FLASH_INDEX:
-            return (can_comm_canlib_payload_handle_callback_t)programmer_flash_handle;
-        case BMS_CELLBOARD_SET_BALANCING_STATUS_INDEX:
-            return (can_comm_canlib_payload_handle_callback_t)bal_set_balancing_status_handle;
+_STATIC can_index_t can_comm_tx_priority_index[CAN_COMM_TX_SENT_COUNT];
+_STATIC uint8_t can_comm_tx_priority[CAN_COMM_MESSAGE_COUNT];
+
+/**
+ * @brief Update the CAN communication error based on the result of a transmission
+ *
+ * @param ret The return code of the transmission
+ */
+_STATIC_INLINE void _can_comm_update_tx_error(const CanCommReturnCode ret) {
+    /*
+     * Set an error in case of problems with CAN communication
+     * In case of any invalid data the error is not set because the communication
+     * is partially working but the data is not valid
+     * A busy hardware is not an error because the message is sent afterwards
+     */
+    switch (ret) {
+        case CAN_COMM_INVALID_INDEX:
+        case CAN_COMM_INVALID_PAYLOAD_SIZE:
+        case CAN_COMM_INVALID_FRAME_TYPE:
+        case CAN_COMM_BUSY:
+            // Do nothing
+            break;
+        case CAN_COMM_OK:
+            error_reset(ERROR_GROUP_CAN_COMMUNICATION, ERROR_CAN_INSTANCE_BMS);
+            break;
         default:
-            return NULL;
+            error_set(ERROR_GROUP_CAN_COMMUNICATION, ERROR_CAN_INSTANCE_BMS);
+            break;
+    }
+}
+
+/**
+ * @brief Send a serialized message via the CAN bus
+ *
+ * @details If the messages are sent from the transmission complete interrupt
+ * the error is updated afterwards inside the routine
+ *
+ * @attention The index must be of a message sent by the cellboard
+ *
+ * @param index The message index
+ * @param frame_type The frame type
+ * @param data The serialized payload
+ * @param size The size of the serialized payload in bytes
+ *
+ * @return CanCommReturnCode The return code of the send callback
+ */
+_STATIC_INLINE CanCommReturnCode _can_comm_transmit(
+    const can_index_t index,
+    const CanFrameType frame_type,
+    const uint8_t * const data,
+    const size_t size)
+{
+    const CanCommReturnCode ret = hcan_comm.send(
+        can_comm_id[index],
+        frame_type,
+        data,
+        size
+    );
+
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    if (ret != CAN_COMM_BUSY) {
+        hcan_comm.tx_ret = ret;
+        hcan_comm.tx_ret_updated = true;
+    }
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+    _can_comm_update_tx_error(ret);
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+    return ret;
+}
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Read the timestamp counter
+ *
+ * @return uint16_t The counter value or 0 if the counter can't be read
+ */
+_STATIC_INLINE uint16_t _can_comm_stats_get_timestamp(void) {
+    return (hcan_comm.timestamp_get != NULL) ? hcan_comm.timestamp_get() : 0U;
+}
+
+/**
+ * @brief Get the bin of the latency histogram where a latency is counted
+ *
+ * @param latency The latency in timestamp counts
+ *
+ * @return size_t The index of the bin
+ */
+_STATIC_INLINE size_t _can_comm_stats_get_latency_bin(const uint16_t latency) {
+    if (latency < (1U << CAN_COMM_STATS_LATENCY_FIRST_BIN_BIT))
+        return 0U;
+    // The upper limit of each bin is a power of two so the bin is given by the most significant bit
+    const size_t msb = 31U - (size_t)__builtin_clz(latency);
+    return CELLBOARD_MIN(msb - CAN_COMM_STATS_LATENCY_FIRST_BIN_BIT + 1U, CAN_COMM_STATS_LATENCY_BIN_COUNT - 1U);
+}
+
+/**
+ * @brief Send a serialized message via the CAN bus and update its statistics
+ *
+ * @details The frame accepted by the hardware waits for its transmission
+ * event, if a previous frame of the same message is still waiting its
+ * enqueue time is kept so that the event of the older frame is not measured
+ * with the time of the newer one
+ *
+ * @attention The index must be of a message sent by the cellboard
+ *
+ * @param index The message index
+ * @param frame_type The frame type
+ * @param data The serialized payload
+ * @param size The size of the serialized payload in bytes
+ * @param enqueue_time The value of the timestamp counter when the message started waiting
+ *
+ * @return CanCommReturnCode The return code of the send callback
+ */
+_STATIC_INLINE CanCommReturnCode _can_comm_transmit_measured(
+    const can_index_t index,
+    const CanFrameType frame_type,
+    const uint8_t * const data,
+    const size_t size,
+    const uint16_t enqueue_time)
+{
+#ifndef CONF_CAN_COMM_TX_ISR_ENABLE
+    // The transmission event must not be handled before the frame is marked as in flight
+    hcan_comm.cs_enter();
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+    const uint8_t position = can_comm_tx_position[index];
+    const CanCommReturnCode ret = _can_comm_transmit(index, frame_type, data, size);
+    if (ret == CAN_COMM_OK) {
+        if (!hcan_comm.tx_in_flight[position]) {
+            hcan_comm.tx_in_flight_time[position] = enqueue_time;
+            hcan_comm.tx_in_flight[position] = true;
+        }
+    }
+    else if (ret != CAN_COMM_BUSY)
+        ++hcan_comm.stats.tx[position].errors;
+
+#ifndef CONF_CAN_COMM_TX_ISR_ENABLE
+    hcan_comm.cs_exit();
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+    return ret;
+}
+
+/**
+ * @brief Update the statistics of a message that is added to its mailbox
+ *
+ * @details The enqueue time is updated only if the message was not already
+ * waiting, otherwise the previous payload is lost and counted as overwritten
+ *
+ * @attention The index must be of a message sent by the cellboard
+ *
+ * @param index The message index
+ * @param pending True if the message was already waiting to be sent, false otherwise
+ */
+_STATIC_INLINE void _can_comm_stats_update_tx_add(const can_index_t index, const bool pending) {
+    const uint8_t position = can_comm_tx_position[index];
+    if (pending)
+        ++hcan_comm.stats.tx[position].overwritten;
+    else
+        hcan_comm.tx_enqueue_time[position] = _can_comm_stats_get_timestamp();
+}
+
+/** @brief Update the high-water mark of the messages waiting to be sent */
+_STATIC_INLINE void _can_comm_stats_update_tx_pending(void) {
+    const uint8_t count = (uint8_t)__builtin_popcount(hcan_comm.tx_pending);
+    hcan_comm.stats.tx_pending_max = CELLBOARD_MAX(hcan_comm.stats.tx_pending_max, count);
+}
+
+/**
+ * @brief Update the high-water mark of the reception queue
+ *
+ * @attention This function must be called only by the producer
+ */
+_STATIC_INLINE void _can_comm_stats_update_rx_queue(void) {
+    const size_t head = atomic_load_explicit(&hcan_comm.rx_queue.head, memory_order_relaxed);
+    const size_t tail = atomic_load_explicit(&hcan_comm.rx_queue.tail, memory_order_relaxed);
+    const uint8_t count = (uint8_t)(head - tail);
+    hcan_comm.stats.rx_queue_max = CELLBOARD_MAX(hcan_comm.stats.rx_queue_max, count);
+}
+
+#else  // CONF_CAN_COMM_STATS_ENABLE
+
+#define _can_comm_transmit_measured(index, frame_type, data, size, enqueue_time) \
+    _can_comm_transmit(index, frame_type, data, size)
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Serialize the payload inside the mailbox of a message
+ *
+ * @details The payload is not serialized again if the last serialized frame
+ * is still valid
+ *
+ * @param index The message index
+ *
+ * @return CanCommReturnCode
+ *     - CAN_COMM_CONVERSION_ERROR there was an error during the conversion of the message
+ *     - CAN_COMM_OK otherwise
+ */
+_STATIC_INLINE CanCommReturnCode _can_comm_tx_serialize(const can_index_t index) {
+    const uint8_t position = can_comm_tx_position[index];
+    if (hcan_comm.tx_frame_valid[position])
+        return CAN_COMM_OK;
+
+    const int size = can_comm_serialize[index](hcan_comm.tx_mailbox[position], hcan_comm.tx_frame[position]);
+    if (size < 0)
+        return CAN_COMM_CONVERSION_ERROR;
+    hcan_comm.tx_frame_size[position] = (uint8_t)size;
+    hcan_comm.tx_frame_valid[position] = true;
+    hcan_comm.tx_frame_serialized[position] = true;
+    return CAN_COMM_OK;
+}
+
+/**
+ * @brief Update the cache counters after the serialized frame of a message is sent
+ *
+ * @details A frame that waited for the hardware is counted only once
+ *
+ * @param index The message index
+ */
+_STATIC_INLINE void _can_comm_tx_update_cache_count(const can_index_t index) {
+    const uint8_t position = can_comm_tx_position[index];
+    if (hcan_comm.tx_frame_serialized[position])
+        ++hcan_comm.tx_cache_miss;
+    else
+        ++hcan_comm.tx_cache_hit;
+    hcan_comm.tx_frame_serialized[position] = false;
+}
+
+/**
+ * @brief Sort the messages sent by the cellboard by their identifier
+ *
+ * @details The list is small and sorted once at startup so an insertion sort is used
+ */
+_STATIC_INLINE void _can_comm_tx_sort_priority(void) {
+    for (size_t i = 0U; i < CAN_COMM_TX_SENT_COUNT; ++i) {
+        const can_index_t index = can_comm_tx_index[i];
+        size_t j = i;
+        for (; j > 0U && can_comm_id[can_comm_tx_priority_index[j - 1U]] > can_comm_id[index]; --j)
+            can_comm_tx_priority_index[j] = can_comm_tx_priority_index[j - 1U];
+        can_comm_tx_priority_index[j] = index;
+    }
+    for (size_t i = 0U; i < CAN_COMM_TX_SENT_COUNT; ++i)
+        can_comm_tx_priority[can_comm_tx_priority_index[i]] = (uint8_t)i;
+}
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Get the index of a message sent by the cellboard from its identifier
+ *
+ * @details The sent messages are already sorted by identifier so a binary search is used
+ *
+ * @param id The CAN identifier
+ *
+ * @return can_index_t The message index or CAN_COMM_MESSAGE_COUNT if the message is not sent by the cellboard
+ */
+_STATIC_INLINE can_index_t _can_comm_tx_find_index(const can_id_t id) {
+    size_t low = 0U;
+    size_t high = CAN_COMM_TX_SENT_COUNT;
+    while (low < high) {
+        const size_t mid = (low + high) / 2U;
+        const can_index_t index = can_comm_tx_priority_index[mid];
+        if (can_comm_id[index] == id)
+            return index;
+        if (can_comm_id[index] < id)
+            low = mid + 1U;
+        else
+            high = mid;
     }
+    return CAN_COMM_MESSAGE_COUNT;
 }
 
-CanCommReturnCode can_comm_init(const can_comm_transmit_callback_t send) {
-    if (send == NULL)
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
+/**
+ * @brief Send a waiting message
+ *
+ * @details The message is removed from the queue only if the hardware accepts it
+ *
+ * @attention This function must be called with the transmission interrupt
+ * disabled or from the interrupt itself if the interrupt is used
+ *
+ * @param priority The priority of a message waiting to be sent
+ *
+ * @return CanCommReturnCode The return code of the transmission
+ */
+_STATIC_INLINE CanCommReturnCode _can_comm_tx_send(const uint8_t priority) {
+    const can_index_t index = can_comm_tx_priority_index[priority];
+    const uint8_t position = can_comm_tx_position[index];
+
+    const CanFrameType frame_type = hcan_comm.tx_frame_type[position];
+    CanCommReturnCode ret = CAN_COMM_OK;
+    size_t size = 0U;
+    if (frame_type != CAN_FRAME_TYPE_REMOTE) {
+        ret = _can_comm_tx_serialize(index);
+        size = hcan_comm.tx_frame_size[position];
+    }
+    if (ret == CAN_COMM_OK)
+        ret = _can_comm_transmit_measured(index, frame_type, hcan_comm.tx_frame[position], size, hcan_comm.tx_enqueue_time[position]);
+    if (ret == CAN_COMM_BUSY)
+        return ret;
+    if (frame_type != CAN_FRAME_TYPE_REMOTE)
+        _can_comm_tx_update_cache_count(index);
+
+    // Remove the message from the queue to notify that it is not inside its mailbox anymore
+    hcan_comm.tx_pending = CELLBOARD_BIT_RESET(hcan_comm.tx_pending, priority);
+    return ret;
+}
+
+/**
+ * @brief Send the waiting message with the highest priority
+ *
+ * @details The message with the lowest identifier is sent first
+ *
+ * @attention This function must be called with the transmission interrupt
+ * disabled or from the interrupt itself if the interrupt is used
+ *
+ * @return CanCommReturnCode
+ *     - CAN_COMM_OK if there are no messages waiting to be sent
+ *     - The return code of the transmission otherwise
+ */
+_STATIC_INLINE CanCommReturnCode _can_comm_tx_send_front(void) {
+    if (hcan_comm.tx_pending == 0U)
+        return CAN_COMM_OK;
+    return _can_comm_tx_send((uint8_t)__builtin_ctz(hcan_comm.tx_pending));
+}
+
+/**
+ * @brief Get the slot of the reception queue where the next message can be written
+ *
+ * @attention This function must be called only by the producer
+ *
+ * @details The tail is loaded with acquire semantic so that the slot is not
+ * overwritten before the consumer has finished reading it
+ *
+ * @return CanMessage * A pointer to the free slot or NULL if the queue is full
+ */
+_STATIC CanMessage * _can_comm_rx_reserve(void) {
+    const size_t head = atomic_load_explicit(&hcan_comm.rx_queue.head, memory_order_relaxed);
+    const size_t tail = atomic_load_explicit(&hcan_comm.rx_queue.tail, memory_order_acquire);
+    if (head - tail >= CAN_COMM_RX_QUEUE_SIZE)
+        return NULL;
+    return &hcan_comm.rx_queue.data[head & CAN_COMM_RX_QUEUE_MASK];
+}
+
+/**
+ * @brief Make the message written in the reserved slot visible to the consumer
+ *
+ * @attention This function must be called only by the producer after the slot is written
+ */
+_STATIC void _can_comm_rx_commit(void) {
+    const size_t head = atomic_load_explicit(&hcan_comm.rx_queue.head, memory_order_relaxed);
+    atomic_store_explicit(&hcan_comm.rx_queue.head, head + 1U, memory_order_release);
+}
+
+/**
+ * @brief Get the oldest message of the reception queue without removing it
+ *
+ * @attention This function must be called only by the consumer
+ *
+ * @details The head is loaded with acquire semantic so that the content of
+ * the message written by the producer is visible
+ *
+ * @return CanMessage * A pointer to the message or NULL if the queue is empty
+ */
+_STATIC CanMessage * _can_comm_rx_peek(void) {
+    const size_t tail = atomic_load_explicit(&hcan_comm.rx_queue.tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&hcan_comm.rx_queue.head, memory_order_acquire);
+    if (head == tail)
+        return NULL;
+    return &hcan_comm.rx_queue.data[tail & CAN_COMM_RX_QUEUE_MASK];
+}
+
+/**
+ * @brief Remove the oldest message from the reception queue giving its slot back to the producer
+ *
+ * @attention This function must be called only by the consumer after the message is handled
+ */
+_STATIC void _can_comm_rx_release(void) {
+    const size_t tail = atomic_load_explicit(&hcan_comm.rx_queue.tail, memory_order_relaxed);
+    atomic_store_explicit(&hcan_comm.rx_queue.tail, tail + 1U, memory_order_release);
+}
+
+/**
+ * @brief Deserialize a received message and call its payload handler
+ *
+ * @param msg A pointer to the received message
+ */
+_STATIC_INLINE void _can_comm_rx_handle(const CanMessage * const msg) {
+    // Deserialize only the messages that are actually handled, remote frames never reach the queue
+    const can_comm_canlib_deserialize_callback_t deserialize = can_comm_deserialize[msg->index];
+    if (deserialize != NULL)
+        deserialize(msg->payload.rx);
+}
+
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+
+/**
+ * @brief Send the messages of the transmission queue until it is empty or the hardware is full
+ *
+ * @attention This function must be called with the transmission interrupt
+ * disabled or from the interrupt itself
+ */
+_STATIC_INLINE void _can_comm_tx_fill(void) {
+    while (hcan_comm.tx_pending != 0U) {
+        if (_can_comm_tx_send_front() == CAN_COMM_BUSY)
+            return;
+    }
+}
+
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+CanCommReturnCode can_comm_init(
+    const can_comm_transmit_callback_t send,
+    const interrupt_critical_section_enter_t cs_enter,
+    const interrupt_critical_section_exit_t cs_exit)
+{
+    if (send == NULL || cs_enter == NULL || cs_exit == NULL)
         return CAN_COMM_NULL_POINTER;
 
     CAN_COMM_DISABLE_ALL(hcan_comm.enabled);
     hcan_comm.send = send;
-
-    // Return values are ignored becuase the buffer addresses are always not NULL
-    (void)ring_buffer_init(&hcan_comm.tx_buf, CanMessage, CAN_COMM_TX_BUFFER_BYTE_SIZE, NULL, NULL);
-    // TODO: Add callbacks to stop CAN reception interrupt during ring buffer operations
-    (void)ring_buffer_init(&hcan_comm.rx_buf, CanMessage, CAN_COMM_RX_BUFFER_BYTE_SIZE, NULL, NULL);
-
-    // Initialize the canlib device
-    device_init(&hcan_comm.rx_device);
-    device_set_address(
-        &hcan_comm.rx_device,
-        &hcan_comm.rx_raw,
-        bms_MAX_STRUCT_SIZE_RAW,
-        &hcan_comm.rx_conv,
-        bms_MAX_STRUCT_SIZE_CONVERSION
-    );
+    hcan_comm.cs_enter = cs_enter;
+    hcan_comm.cs_exit = cs_exit;
+    hcan_comm.tx_ret = CAN_COMM_OK;
+    hcan_comm.tx_ret_updated = false;
+    memset(hcan_comm.tx_dirty, 0U, sizeof(hcan_comm.tx_dirty));
+    memset(hcan_comm.tx_frame_valid, 0U, sizeof(hcan_comm.tx_frame_valid));
+    memset(hcan_comm.tx_frame_serialized, 0U, sizeof(hcan_comm.tx_frame_serialized));
+    hcan_comm.tx_cache_hit = 0U;
+    hcan_comm.tx_cache_miss = 0U;
+
+    hcan_comm.tx_pending = 0U;
+    _can_comm_tx_sort_priority();
+    atomic_init(&hcan_comm.rx_queue.head, 0U);
+    atomic_init(&hcan_comm.rx_queue.tail, 0U);
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+    can_comm_stats_reset();
+#endif // CONF_CAN_COMM_STATS_ENABLE
     return CAN_COMM_OK;
 }
 
@@ -108,32 +657,34 @@ CanCommReturnCode can_comm_send_immediate(
         return CAN_COMM_DISABLED;
 
     // Check parameters validity
-    if (index >= bms_MESSAGE_COUNT)
+    if (index >= CAN_COMM_MESSAGE_COUNT || can_comm_serialize[index] == NULL)
         return CAN_COMM_INVALID_INDEX;
     if (frame_type >= CAN_FRAME_TYPE_COUNT)
         return CAN_COMM_INVALID_FRAME_TYPE;
-    // TODO: Change the max payload with the maximum size of the converted struct
-    // if (size > CAN_COMM_MAX_PAYLOAD_BYTE_SIZE)
-    //     return CAN_COMM_INVALID_PAYLOAD_SIZE;
+    if (size > CAN_COMM_TX_MAILBOX_BYTE_SIZE)
+        return CAN_COMM_INVALID_PAYLOAD_SIZE;
     if (data == NULL && frame_type != CAN_FRAME_TYPE_REMOTE)
         return CAN_COMM_NULL_POINTER;
 
-    // Prepare and push message to the buffer
-    CanMessage msg = {
-        .index = index,
-        .frame_type = frame_type
-    };
-    if (frame_type != CAN_FRAME_TYPE_REMOTE)
-        memcpy(msg.payload.tx, data, size);
-
-    // If the buffer is full run the routine to free space for the new message
-    if (ring_buffer_is_full(&hcan_comm.tx_buf))
-        (void)can_comm_routine();
+    // The message does not pass through its mailbox so it is always serialized
+    uint8_t frame[CAN_COMM_TX_FRAME_BYTE_SIZE];
+    int frame_size = 0;
+    if (frame_type != CAN_FRAME_TYPE_REMOTE) {
+        frame_size = can_comm_serialize[index](data, frame);
+        if (frame_size < 0)
+            return CAN_COMM_CONVERSION_ERROR;
+    }
 
-    // Add and send the new message
-    if (ring_buffer_push_front(&hcan_comm.tx_buf, &msg) == RING_BUFFER_OK)
-        return can_comm_routine();
-    return CAN_COMM_OVERRUN;
+    // The message does not wait inside its mailbox so it is enqueued right now
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    // The hardware is shared with the transmission complete interrupt
+    hcan_comm.cs_enter();
+    const CanCommReturnCode ret = _can_comm_transmit_measured(index, frame_type, frame, frame_size, _can_comm_stats_get_timestamp());
+    hcan_comm.cs_exit();
+    return ret;
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+    return _can_comm_transmit_measured(index, frame_type, frame, frame_size, _can_comm_stats_get_timestamp());
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
 }
 
 CanCommReturnCode can_comm_tx_add(
@@ -146,27 +697,48 @@ CanCommReturnCode can_comm_tx_add(
         return CAN_COMM_DISABLED;
 
     // Check parameters validity
-    if (index >= bms_MESSAGE_COUNT)
+    if (index >= CAN_COMM_MESSAGE_COUNT || can_comm_serialize[index] == NULL)
         return CAN_COMM_INVALID_INDEX;
     if (frame_type >= CAN_FRAME_TYPE_COUNT)
         return CAN_COMM_INVALID_FRAME_TYPE;
-    // TODO: Change the max payload with the maximum size of the converted struct
-    // if (size > CAN_COMM_MAX_PAYLOAD_BYTE_SIZE)
-    //     return CAN_COMM_INVALID_PAYLOAD_SIZE;
+    if (size > CAN_COMM_TX_MAILBOX_BYTE_SIZE)
+        return CAN_COMM_INVALID_PAYLOAD_SIZE;
     if (data == NULL && frame_type != CAN_FRAME_TYPE_REMOTE)
         return CAN_COMM_NULL_POINTER;
 
-    // Prepare and push message to the buffer
-    CanMessage msg = {
-        .index = index,
-        .frame_type = frame_type
-    };
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    // The mailboxes and the queue are shared with the transmission complete interrupt
+    hcan_comm.cs_enter();
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+    // Update the mailbox with the latest payload
+    const uint8_t position = can_comm_tx_position[index];
+    hcan_comm.tx_frame_type[position] = frame_type;
     if (frame_type != CAN_FRAME_TYPE_REMOTE)
-        memcpy(msg.payload.tx, data, size);
+        memcpy(hcan_comm.tx_mailbox[position], data, size);
 
-    if (ring_buffer_push_back(&hcan_comm.tx_buf, &msg) == RING_BUFFER_FULL)
-        return CAN_COMM_OVERRUN;
-    hcan_comm.tx_busy[index] = true;
+    // The last serialized frame is discarded unless the payload is known to be unchanged
+    if (!can_comm_tx_cached[index] || hcan_comm.tx_dirty[position]) {
+        hcan_comm.tx_dirty[position] = false;
+        hcan_comm.tx_frame_valid[position] = false;
+    }
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+    _can_comm_stats_update_tx_add(index, CELLBOARD_BIT_GET(hcan_comm.tx_pending, can_comm_tx_priority[index]));
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
+    // Every message has its own place in the queue so a waiting message is sent only once
+    hcan_comm.tx_pending = CELLBOARD_BIT_SET(hcan_comm.tx_pending, can_comm_tx_priority[index]);
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+    _can_comm_stats_update_tx_pending();
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    // Start the transmission if the hardware is not already sending other messages
+    _can_comm_tx_fill();
+    hcan_comm.cs_exit();
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
     return CAN_COMM_OK;
 }
 
@@ -180,7 +752,7 @@ CanCommReturnCode can_comm_rx_add(
         return CAN_COMM_DISABLED;
 
     // Check parameters validity
-    if (index >= bms_MESSAGE_COUNT)
+    if (index >= CAN_COMM_MESSAGE_COUNT)
         return CAN_COMM_INVALID_INDEX;
     if (data == NULL && frame_type != CAN_FRAME_TYPE_REMOTE)
         return CAN_COMM_NULL_POINTER;
@@ -188,97 +760,178 @@ CanCommReturnCode can_comm_rx_add(
         return CAN_COMM_INVALID_PAYLOAD_SIZE;
     if (frame_type >= CAN_FRAME_TYPE_COUNT)
         return CAN_COMM_INVALID_FRAME_TYPE;
+    /*
+     * Remote requests are not answered: every cellboard sends the same
+     * identifiers, so all of them would answer the same request at once
+     * with different payloads
+     */
+    if (frame_type == CAN_FRAME_TYPE_REMOTE)
+        return CAN_COMM_INVALID_FRAME_TYPE;
 
-    // Prepare and push message to the buffer
-    CanMessage msg = {
-        .index = index,
-        .frame_type = frame_type
-    };
-    if (frame_type != CAN_FRAME_TYPE_REMOTE)
-        memcpy(msg.payload.rx, data, size);
-
-    if (ring_buffer_push_back(&hcan_comm.rx_buf, &msg) == RING_BUFFER_FULL)
+    // Write the message directly inside the queue
+    CanMessage * const msg = _can_comm_rx_reserve();
+    if (msg == NULL) {
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+        ++hcan_comm.stats.rx_overrun;
+#endif // CONF_CAN_COMM_STATS_ENABLE
         return CAN_COMM_OVERRUN;
-    hcan_comm.rx_busy[index] = true;
+    }
+    msg->index = index;
+    msg->frame_type = frame_type;
+    memcpy(msg->payload.rx, data, size);
+    _can_comm_rx_commit();
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+    _can_comm_stats_update_rx_queue();
+#endif // CONF_CAN_COMM_STATS_ENABLE
     return CAN_COMM_OK;
 }
 
+size_t can_comm_get_rx_ids(can_id_t * const ids, const size_t size) {
+    if (ids == NULL)
+        return 0U;
+
+    const size_t count = CELLBOARD_MIN(size, CAN_COMM_RX_HANDLED_COUNT);
+    for (size_t i = 0U; i < count; ++i)
+        ids[i] = can_comm_id[can_comm_rx_index[i]];
+    return count;
+}
+
+can_index_t can_comm_get_rx_index(const size_t filter) {
+    return (filter < CAN_COMM_RX_HANDLED_COUNT) ? can_comm_rx_index[filter] : CAN_COMM_MESSAGE_COUNT;
+}
+
+void can_comm_tx_set_dirty(const can_index_t index) {
+    if (index >= CAN_COMM_MESSAGE_COUNT || can_comm_serialize[index] == NULL)
+        return;
+    hcan_comm.tx_dirty[can_comm_tx_position[index]] = true;
+}
+
+uint32_t can_comm_get_tx_cache_hit_count(void) {
+    return hcan_comm.tx_cache_hit;
+}
+
+uint32_t can_comm_get_tx_cache_miss_count(void) {
+    return hcan_comm.tx_cache_miss;
+}
+
+size_t can_comm_tx_get_pending_count(void) {
+    return (size_t)__builtin_popcount(hcan_comm.tx_pending);
+}
+
+bool can_comm_tx_is_pending(const can_index_t index) {
+    if (index >= CAN_COMM_MESSAGE_COUNT || can_comm_serialize[index] == NULL)
+        return false;
+    return CELLBOARD_BIT_GET(hcan_comm.tx_pending, can_comm_tx_priority[index]);
+}
+
+bool can_comm_is_idle(void) {
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    // The transmission does not need the main loop
+    const bool tx_idle = true;
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+    const bool tx_idle = !CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_TX_ENABLE_BIT) ||
+        hcan_comm.tx_pending == 0U;
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+    const bool rx_idle = !CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_RX_ENABLE_BIT) ||
+        _can_comm_rx_peek() == NULL;
+    return tx_idle && rx_idle;
+}
+
 CanCommReturnCode can_comm_routine(void) {
     // Handler transmit and receive data
     CanCommReturnCode ret = CAN_COMM_OK;
-    CanMessage tx_msg, rx_msg;
-    if (CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_TX_ENABLE_BIT) &&
-        ring_buffer_pop_front(&hcan_comm.tx_buf, &tx_msg) == RING_BUFFER_OK)
-    {
-        // Reset the busy flag to notify that the message is not inside the buffer anymore
-        hcan_comm.tx_busy[tx_msg.index] = false;
-
-        uint8_t data[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE];
-        int size = 0;
-        const can_id_t can_id = bms_id_from_index(tx_msg.index);
-
-        if (tx_msg.frame_type != CAN_FRAME_TYPE_REMOTE) {
-            // Serialize message
-            size = bms_serialize_from_id(tx_msg.payload.tx, can_id, data);
-            if (size < 0)
-                return CAN_COMM_CONVERSION_ERROR;
-        }
-
-        // Send message
-        ret = hcan_comm.send(
-            can_id,
-            tx_msg.frame_type,
-            data,
-            size
-        );
-
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    // Update the error with the result of the transmissions done by the interrupt
+    if (hcan_comm.tx_ret_updated) {
+        hcan_comm.tx_ret_updated = false;
+        _can_comm_update_tx_error(hcan_comm.tx_ret);
+    }
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+    if (CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_TX_ENABLE_BIT)) {
+        ret = _can_comm_tx_send_front();
+        // The message stays in its mailbox until the hardware has room for it
+        if (ret == CAN_COMM_BUSY)
+            ret = CAN_COMM_OK;
+    }
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+    if (CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_RX_ENABLE_BIT)) {
         /*
-         * Set an error in case of problems with CAN communication
-         * In case of any invalid data the error is not set because the communication
-         * is partially working but the data is not valid
+         * Handle every received message in place, the number of iterations is
+         * limited so that messages that keep arriving can't stall the main loop
          */
-        switch (ret) {
-            case CAN_COMM_INVALID_INDEX:
-            case CAN_COMM_INVALID_PAYLOAD_SIZE:
-            case CAN_COMM_INVALID_FRAME_TYPE:
-                // Do nothing
-                break;
-            case CAN_COMM_OK:
-                error_reset(ERROR_GROUP_CAN_COMMUNICATION, ERROR_CAN_INSTANCE_BMS);
-                break;
-            default:
-                error_set(ERROR_GROUP_CAN_COMMUNICATION, ERROR_CAN_INSTANCE_BMS);
-                break;
+        size_t count = 0U;
+        const CanMessage * rx_msg = NULL;
+        for (; count < CAN_COMM_RX_QUEUE_SIZE && (rx_msg = _can_comm_rx_peek()) != NULL; ++count) {
+            _can_comm_rx_handle(rx_msg);
+            _can_comm_rx_release();
         }
+
+        // Reset CAN error
+        if (count > 0U)
+            error_reset(ERROR_GROUP_CAN_COMMUNICATION, ERROR_CAN_INSTANCE_BMS);
     }
-    if (CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_RX_ENABLE_BIT) &&
-        ring_buffer_pop_front(&hcan_comm.rx_buf, &rx_msg) == RING_BUFFER_OK)
-    {
-        // Reset the busy flag to notify that the message is not inside the buffer anymore
-        hcan_comm.rx_busy[rx_msg.index] = false;
 
-        const can_id_t can_id = bms_id_from_index(rx_msg.index);
+    return ret;
+}
 
-        // Reset CAN error
-        error_reset(ERROR_GROUP_CAN_COMMUNICATION, ERROR_CAN_INSTANCE_BMS);
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
 
-        if (rx_msg.frame_type != CAN_FRAME_TYPE_REMOTE) {
-            // Deserialize message
-            bms_devices_deserialize_from_id(&hcan_comm.rx_device, can_id, rx_msg.payload.rx);
+void can_comm_tx_pump(void) {
+    if (!CAN_COMM_IS_ENABLED(hcan_comm.enabled, CAN_COMM_TX_ENABLE_BIT))
+        return;
+    _can_comm_tx_fill();
+}
 
-            can_comm_canlib_payload_handle_callback_t handle_payload = _can_comm_payload_handle(rx_msg.index);
-            if (handle_payload != NULL) {
-                handle_payload(hcan_comm.rx_device.message);
-            }
-        }
-        else {
-            // TODO: Handler remote requests
-        }
-    }
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
 
-    return ret;
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+CanCommReturnCode can_comm_stats_init(const can_comm_timestamp_get_callback_t timestamp_get) {
+    if (timestamp_get == NULL)
+        return CAN_COMM_NULL_POINTER;
+    hcan_comm.timestamp_get = timestamp_get;
+    can_comm_stats_reset();
+    return CAN_COMM_OK;
+}
+
+void can_comm_stats_reset(void) {
+    memset(&hcan_comm.stats, 0U, sizeof(hcan_comm.stats));
+    memset(hcan_comm.tx_in_flight, 0U, sizeof(hcan_comm.tx_in_flight));
+}
+
+const CanCommStats * can_comm_stats_get(void) {
+    return &hcan_comm.stats;
+}
+
+const CanCommTxStats * can_comm_stats_get_tx(const can_index_t index) {
+    if (index >= CAN_COMM_MESSAGE_COUNT || can_comm_serialize[index] == NULL)
+        return NULL;
+    return &hcan_comm.stats.tx[can_comm_tx_position[index]];
 }
 
+void can_comm_stats_notify_tx_event(const can_id_t id, const uint16_t timestamp) {
+    const can_index_t index = _can_comm_tx_find_index(id);
+    if (index >= CAN_COMM_MESSAGE_COUNT)
+        return;
+    const uint8_t position = can_comm_tx_position[index];
+    CanCommTxStats * const stats = &hcan_comm.stats.tx[position];
+    ++stats->sent;
+
+    // The frame is not measured if its enqueue time is unknown
+    if (!hcan_comm.tx_in_flight[position])
+        return;
+    hcan_comm.tx_in_flight[position] = false;
+    if (hcan_comm.timestamp_get == NULL)
+        return;
+
+    // The unsigned difference is correct even if the counter wraps around once
+    const uint16_t latency = timestamp - hcan_comm.tx_in_flight_time[position];
+    stats->latency_max = CELLBOARD_MAX(stats->latency_max, latency);
+    ++stats->latency_hist[_can_comm_stats_get_latency_bin(latency)];
+}
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
 #ifdef CONF_CAN_COMM_STRINGS_ENABLE
 
 _STATIC char * can_comm_module_name = "can communication";
@@ -292,7 +945,8 @@ _STATIC char * can_comm_return_code_name[] = {
     [CAN_COMM_INVALID_PAYLOAD_SIZE] = "invalid payload size",
     [CAN_COMM_INVALID_FRAME_TYPE] = "invalid frame type",
     [CAN_COMM_CONVERSION_ERROR] = "conversion error",
-    [CAN_COMM_TRANSMISSION_ERROR] = "transmission error"
+    [CAN_COMM_TRANSMISSION_ERROR] = "transmission error",
+    [CAN_COMM_BUSY] = "busy"
 };
 
 _STATIC char * can_comm_return_code_description[] = {
@@ -304,7 +958,8 @@ _STATIC char * can_comm_return_code_description[] = {
     [CAN_COMM_INVALID_PAYLOAD_SIZE] = "the payload size is greater than the maximum allowed length"
     [CAN_COMM_INVALID_FRAME_TYPE] = "the given frame type does not correspond to any existing can frame type",
     [CAN_COMM_CONVERSION_ERROR] = "can't convert the message correctly",
-    [CAN_COMM_TRANSMISSION_ERROR] = "error during message transmission"
+    [CAN_COMM_TRANSMISSION_ERROR] = "error during message transmission",
+    [CAN_COMM_BUSY] = "the transmission hardware can't accept any more messages"
 };
 
 #endif // CONF_CAN_COMM_STRINGS_ENABLE
@@ -25,6 +25,7 @@ Functions and types have been generated with prefix "fsm_"
 #include "programmer.h"
 #include "bal.h"
 #include "error.h"
+#include "idle.h"
 /*** USER CODE END MACROS ***/
 
 
@@ -119,6 +120,7 @@ fsm_state_t fsm_do_init(fsm_state_data_t *data) {
   // Init canlib payloads
   const CellboardId id = identity_get_cellboard_id();
   hfsm.status_can_payload.cellboard_id = (int)id;
+  can_comm_tx_set_dirty(BMS_CELLBOARD_STATUS_INDEX);
   hfsm.flash_can_payload.cellboard_id = (int)id;
   hfsm.flash_can_payload.ready = true;
 
@@ -181,6 +183,10 @@ fsm_state_t fsm_do_idle(fsm_state_data_t *data) {
       else if (fsm_fired_event->type == FSM_EVENT_TYPE_BALANCING_START)
           next_state = FSM_STATE_DISCHARGE;
   }
+
+  // Sleep until the next deadline or interrupt if there is nothing left to do
+  if (next_state == FSM_NO_CHANGE)
+      (void)idle_routine();
   /*** USER CODE END DO_IDLE ***/
   
   switch (next_state) {
@@ -214,6 +220,10 @@ fsm_state_t fsm_do_fatal(fsm_state_data_t *data) {
   // Check for flash request
   if (fsm_is_event_triggered() && fsm_fired_event->type == FSM_EVENT_TYPE_FLASH_REQUEST)
       next_state = FSM_STATE_FLASH;
+
+  // Sleep until the next deadline or interrupt if there is nothing left to do
+  if (next_state == FSM_NO_CHANGE)
+      (void)idle_routine();
   /*** USER CODE END DO_FATAL ***/
   
   switch (next_state) {
@@ -286,6 +296,10 @@ fsm_state_t fsm_do_discharge(fsm_state_data_t *data) {
       else if (fsm_fired_event->type == FSM_EVENT_TYPE_COOLDOWN_REQUEST)
           next_state = FSM_STATE_COOLDOWN;
   }
+
+  // Sleep until the next deadline or interrupt if there is nothing left to do
+  if (next_state == FSM_NO_CHANGE)
+      (void)idle_routine();
   /*** USER CODE END DO_DISCHARGE ***/
   
   switch (next_state) {
@@ -326,6 +340,10 @@ fsm_state_t fsm_do_cooldown(fsm_state_data_t *data) {
       else if (fsm_fired_event->type == FSM_EVENT_TYPE_DISCHARGE_REQUEST)
           next_state = FSM_STATE_DISCHARGE;
   }
+
+  // Sleep until the next deadline or interrupt if there is nothing left to do
+  if (next_state == FSM_NO_CHANGE)
+      (void)idle_routine();
   /*** USER CODE END DO_COOLDOWN ***/
   
   switch (next_state) {
@@ -517,7 +535,11 @@ bms_cellboard_status_converted_t * fsm_get_status_canlib_payload(size_t * const
     if (byte_size != NULL)
         *byte_size = sizeof(hfsm.status_can_payload);
     // Cellboard id is saved during the init state
-    hfsm.status_can_payload.status = (bms_cellboard_status_status)hfsm.fsm_state;
+    const bms_cellboard_status_status status = (bms_cellboard_status_status)hfsm.fsm_state;
+    if (hfsm.status_can_payload.status != status) {
+        hfsm.status_can_payload.status = status;
+        can_comm_tx_set_dirty(BMS_CELLBOARD_STATUS_INDEX);
+    }
     return &hfsm.status_can_payload;
 }
 /*** USER CODE END FUNCTIONS ***/
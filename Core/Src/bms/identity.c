@@ -11,6 +11,8 @@
 #include <time.h>
 #include <string.h>
 
+#include "can-comm.h"
+
 #ifdef CONF_IDENTITY_MODULE_ENABLE
 
 _STATIC _IdentityHandler hidentity;
@@ -31,6 +33,7 @@ void identity_init(const CellboardId id) {
     hidentity.version_can_payload.cellboard_id = (bms_cellboard_version_cellboard_id)id;
     hidentity.version_can_payload.component_build_time = hidentity.build_time >> 3U; // Remove 3 bits to keep size inside the allowed range
     hidentity.version_can_payload.canlib_build_time = CANLIB_BUILD_TIME;
+    can_comm_tx_set_dirty(BMS_CELLBOARD_VERSION_INDEX);
 }
 
 CellboardId identity_get_cellboard_id(void) {
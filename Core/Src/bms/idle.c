@@ -0,0 +1,122 @@
+/**
+ * @file idle.c
+ * @date 2024-10-16
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ *
+ * @brief Functions used to put the microcontroller to sleep when there is
+ * nothing left to do inside the main loop
+ */
+
+#include "idle.h"
+
+#include <string.h>
+
+#include "can-comm.h"
+#include "timebase.h"
+
+#ifdef CONF_IDLE_MODULE_ENABLE
+
+_STATIC _IdleHandler hidle;
+
+/**
+ * @brief Check if there is still some work to do inside the main loop
+ *
+ * @return bool True if the microcontroller should not sleep, false otherwise
+ */
+_STATIC_INLINE bool _idle_is_busy(void) {
+    return timebase_get_next_deadline() <= timebase_get_tick() || !can_comm_is_idle();
+}
+
+IdleReturnCode idle_init(
+    const idle_sleep_callback_t sleep,
+    const interrupt_critical_section_enter_t cs_enter,
+    const interrupt_critical_section_exit_t cs_exit)
+{
+    if (sleep == NULL || cs_enter == NULL || cs_exit == NULL)
+        return IDLE_NULL_POINTER;
+
+    memset(&hidle, 0U, sizeof(hidle));
+    hidle.enabled = false;
+    hidle.sleep = sleep;
+    hidle.cs_enter = cs_enter;
+    hidle.cs_exit = cs_exit;
+    return IDLE_OK;
+}
+
+void idle_set_enable(const bool enabled) {
+    // The handler can't be enabled if it was not initialized correctly
+    hidle.enabled = enabled && hidle.sleep != NULL;
+}
+
+void idle_notify(const IdleWakeReason reason) {
+    if (reason >= IDLE_WAKE_REASON_COUNT)
+        return;
+    hidle.reasons = CELLBOARD_BIT_SET(hidle.reasons, reason);
+}
+
+IdleReturnCode idle_routine(void) {
+    if (!hidle.enabled)
+        return IDLE_DISABLED;
+    ++hidle.loop_count;
+
+    /**************************************************************************
+     * The interrupts are disabled before the check so that any interrupt
+     * that occurs before the sleep stays pending and wakes up the microcontroller
+     * immediately, the interrupt is then handled when the critical section ends
+     ***************************************************************************/
+    hidle.cs_enter();
+    hidle.reasons = 0U;
+    if (_idle_is_busy()) {
+        hidle.cs_exit();
+        return IDLE_BUSY;
+    }
+    hidle.sleep();
+    hidle.cs_exit();
+
+    // Count the reasons notified by the interrupts that woke up the microcontroller
+    const bit_flag8_t reasons = hidle.reasons;
+    ++hidle.sleep_count;
+    if (reasons == 0U)
+        ++hidle.wake_count[IDLE_WAKE_REASON_OTHER];
+    for (size_t i = 0U; i < IDLE_WAKE_REASON_COUNT; ++i) {
+        if (CELLBOARD_BIT_GET(reasons, i))
+            ++hidle.wake_count[i];
+    }
+    return IDLE_OK;
+}
+
+uint32_t idle_get_loop_count(void) {
+    return hidle.loop_count;
+}
+
+uint32_t idle_get_sleep_count(void) {
+    return hidle.sleep_count;
+}
+
+uint32_t idle_get_wake_count(const IdleWakeReason reason) {
+    if (reason >= IDLE_WAKE_REASON_COUNT)
+        return 0U;
+    return hidle.wake_count[reason];
+}
+
+#ifdef CONF_IDLE_STRINGS_ENABLE
+
+_STATIC char * idle_module_name = "idle";
+
+_STATIC char * idle_return_code_name[] = {
+    [IDLE_OK] = "ok",
+    [IDLE_NULL_POINTER] = "null pointer",
+    [IDLE_DISABLED] = "disabled",
+    [IDLE_BUSY] = "busy"
+};
+
+_STATIC char * idle_return_code_description[] = {
+    [IDLE_OK] = "executed succesfully",
+    [IDLE_NULL_POINTER] = "attempt to dereference a NULL pointer",
+    [IDLE_DISABLED] = "the idle handler is not enabled",
+    [IDLE_BUSY] = "there is still work to do"
+};
+
+#endif // CONF_IDLE_STRINGS_ENABLE
+
+#endif // CONF_IDLE_MODULE_ENABLE
@@ -32,7 +32,7 @@ _STATIC _BmsManagerHandler hmanager;
  *     - BMS_MANAGER_OK otherwise
  */
 BmsManagerReturnCode _bms_manager_send(uint8_t * const data, const size_t size) {
-    _STATIC uint8_t aux;
+    static uint8_t aux;
     return hmanager.send_receive(data, &aux, size, 0U);
 }
 
@@ -57,7 +57,7 @@ BmsManagerReturnCode bms_manager_init(const bms_manager_send_callback_t send, co
 }
 
 BmsManagerReturnCode bms_manager_routine(void) {
-    _STATIC bms_monitor_fsm_state_t state = BMS_MONITOR_FSM_STATE_INIT;
+    static bms_monitor_fsm_state_t state = BMS_MONITOR_FSM_STATE_INIT;
     state = bms_monitor_fsm_run_state(state, NULL);
     return BMS_MANAGER_OK;
 }
@@ -250,8 +250,12 @@ BmsManagerReturnCode bms_manager_read_voltages(const BmsManagerVoltageRegister r
         const size_t index = (reg * LTC6811_REG_CELL_COUNT) + (ltc * LTC6811_CELL_COUNT);
         const size_t off = (CELLBOARD_SEGMENT_LTC_COUNT - ltc - 1U) * LTC6811_REG_CELL_COUNT;
         for (size_t i = 0U; i < LTC6811_REG_CELL_COUNT; ++i) {
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+            volt_update_raw_value(index + i, volts[off + i]);
+#else  // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
             const volt_t value = BMS_MANAGER_RAW_VOLTAGE_TO_VOLT(volts[off + i]);
             volt_update_value(index + i, value);
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
         }
     }
     return BMS_MANAGER_OK;
@@ -20,6 +20,7 @@ Functions and types have been generated with prefix "bms_monitor_fsm_"
 #include <string.h>
 
 #include "timebase.h"
+#include "tasks.h"
 #include "error.h"
 /*** USER CODE END MACROS ***/
 
@@ -230,7 +231,9 @@ bms_monitor_fsm_state_t bms_monitor_fsm_do_read_volt_a(bms_monitor_fsm_state_dat
   /*** USER CODE BEGIN DO_READ_VOLT_A ***/
   CELLBOARD_UNUSED(data);
 
-  (void)bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_A);
+  // Send the fresh voltages as soon as they are decoded
+  if (bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_A) == BMS_MANAGER_OK)
+      tasks_publish_voltages();
   /*** USER CODE END DO_READ_VOLT_A ***/
   
   switch (next_state) {
@@ -253,7 +256,9 @@ bms_monitor_fsm_state_t bms_monitor_fsm_do_read_volt_b(bms_monitor_fsm_state_dat
   /*** USER CODE BEGIN DO_READ_VOLT_B ***/
   CELLBOARD_UNUSED(data);
 
-  (void)bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_B);
+  // Send the fresh voltages as soon as they are decoded
+  if (bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_B) == BMS_MANAGER_OK)
+      tasks_publish_voltages();
   /*** USER CODE END DO_READ_VOLT_B ***/
   
   switch (next_state) {
@@ -276,7 +281,9 @@ bms_monitor_fsm_state_t bms_monitor_fsm_do_read_volt_c(bms_monitor_fsm_state_dat
   /*** USER CODE BEGIN DO_READ_VOLT_C ***/
   CELLBOARD_UNUSED(data);
 
-  (void)bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_C);
+  // Send the fresh voltages as soon as they are decoded
+  if (bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_C) == BMS_MANAGER_OK)
+      tasks_publish_voltages();
   /*** USER CODE END DO_READ_VOLT_C ***/
   
   switch (next_state) {
@@ -299,7 +306,9 @@ bms_monitor_fsm_state_t bms_monitor_fsm_do_read_volt_d(bms_monitor_fsm_state_dat
   /*** USER CODE BEGIN DO_READ_VOLT_D ***/
   CELLBOARD_UNUSED(data);
 
-  (void)bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_D);
+  // Send the fresh voltages as soon as they are decoded
+  if (bms_manager_read_voltages(BMS_MANAGER_VOLTAGE_REGISTER_D) == BMS_MANAGER_OK)
+      tasks_publish_voltages();
   /*** USER CODE END DO_READ_VOLT_D ***/
   
   switch (next_state) {
@@ -42,14 +42,18 @@ PostReturnCode _post_modules_init(const PostInitData * const data) {
      * Some of the function return values can be ignored because they are either
      * always OK or some assertion can be made (like for the NULL checks)
      */
-    (void)timebase_init(1U);
+    if (timebase_init(TIMEBASE_RESOLUTION_MS, data->clock_get, data->clock_set_alarm) != TIMEBASE_OK)
+        return POST_UNINITIALIZED;
+    (void)timebase_profiler_init(data->profiler_clock_get);
     (void)bms_manager_init(data->spi_send, data->spi_send_receive);
     (void)volt_init();
     (void)temp_init(data->gpio_set_address, data->adc_start);
-    (void)can_comm_init(data->can_send);
+    (void)can_comm_init(data->can_send, data->cs_enter, data->cs_exit);
+    (void)can_comm_stats_init(data->can_timestamp_get);
     (void)bal_init();
     (void)programmer_init(data->system_reset);
     (void)led_init(data->led_set, data->led_toggle);
+    (void)idle_init(data->sleep, data->cs_enter, data->cs_exit);
 
     return POST_OK;
 }
@@ -58,6 +62,7 @@ PostReturnCode _post_module_setup(void) {
     timebase_set_enable(true);
     can_comm_enable_all();
     led_set_enable(true);
+    idle_set_enable(true);
     return POST_OK;
 }
 
@@ -65,6 +70,8 @@ PostReturnCode post_run(const PostInitData data) {
     if (data.id >= CELLBOARD_ID_COUNT)
         return POST_INVALID_CELLBOARD_ID;
     if (data.system_reset == NULL ||
+        data.cs_enter == NULL ||
+        data.cs_exit == NULL ||
         data.can_send == NULL ||
         data.spi_send == NULL ||
         data.spi_send_receive == NULL ||
@@ -216,23 +216,76 @@ TempReturnCode temp_dump_values(
     return TEMP_OK;
 }
 
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+/**
+ * @brief Check if a group of cells temperatures has to be sent
+ *
+ * @param offset The index of the first temperature of the group
+ * @param t The current time in ms
+ *
+ * @return bool True if a value moved outside the deadband or the refresh period expired
+ */
+_STATIC_INLINE bool _temp_is_group_changed(const size_t offset, const milliseconds_t t) {
+    const size_t group = offset / TEMP_CAN_GROUP_SIZE;
+    if (!CELLBOARD_BIT_GET(htemp.sent_groups, group) || t - htemp.sent_time[group] >= TEMP_REFRESH_MS)
+        return true;
+    for (size_t i = offset; i < offset + TEMP_CAN_GROUP_SIZE; ++i) {
+        const celsius_t delta = htemp.temperatures[i] - htemp.sent_temperatures[i];
+        if (delta > TEMP_DEADBAND_C || delta < -TEMP_DEADBAND_C)
+            return true;
+    }
+    return false;
+}
+
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+
 bms_cellboard_cells_temperature_converted_t * temp_get_cells_temp_canlib_payload(size_t * const byte_size) {
     if (byte_size != NULL)
         *byte_size = sizeof(htemp.temp_can_payload);
 
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    // Find the next group that has to be sent starting from the current offset
+    const milliseconds_t t = timebase_get_time();
+    size_t i = 0U;
+    for (; i < TEMP_CAN_GROUP_COUNT && !_temp_is_group_changed(htemp.offset, t); ++i) {
+        htemp.offset += TEMP_CAN_GROUP_SIZE;
+        if (htemp.offset >= CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT)
+            htemp.offset = 0U;
+    }
+    if (i >= TEMP_CAN_GROUP_COUNT) {
+        ++htemp.saved_count;
+        return NULL;
+    }
+
+    const size_t group = htemp.offset / TEMP_CAN_GROUP_SIZE;
+    memcpy(htemp.sent_temperatures + htemp.offset, htemp.temperatures + htemp.offset, TEMP_CAN_GROUP_SIZE * sizeof(htemp.temperatures[0U]));
+    htemp.sent_time[group] = t;
+    htemp.sent_groups = CELLBOARD_BIT_SET(htemp.sent_groups, group);
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+
     htemp.temp_can_payload.offset = htemp.offset;
     htemp.temp_can_payload.temperature_0 = htemp.temperatures[htemp.offset];
     htemp.temp_can_payload.temperature_1 = htemp.temperatures[htemp.offset + 1U];
     htemp.temp_can_payload.temperature_2 = htemp.temperatures[htemp.offset + 2U];
     htemp.temp_can_payload.temperature_3 = htemp.temperatures[htemp.offset + 3U];
 
-    htemp.offset += 4U;
+    htemp.offset += TEMP_CAN_GROUP_SIZE;
     if (htemp.offset >= CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT)
         htemp.offset = 0U;
+    ++htemp.sent_count;
 
     return &htemp.temp_can_payload;
 }
 
+uint32_t temp_get_sent_frame_count(void) {
+    return htemp.sent_count;
+}
+
+uint32_t temp_get_saved_frame_count(void) {
+    return htemp.saved_count;
+}
+
 bms_cellboard_discharge_temperature_converted_t * temp_get_discharge_temp_canlib_payload(size_t * const byte_size) {
     if (byte_size != NULL)
         *byte_size = sizeof(htemp.discharge_temp_can_payload);
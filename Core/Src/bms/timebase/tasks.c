@@ -26,6 +26,55 @@
 
 _STATIC _TasksHandler htasks;
 
+#ifdef CONF_TASKS_TDMA_ENABLE
+
+/** @brief Default start and interval in ms of each task, used to place the time slots */
+#define TASKS_X(NAME, ENABLED, START, INTERVAL, PRIORITY, POLICY, EXEC) \
+    TASKS_DEFAULT_START_##NAME = (START), \
+    TASKS_DEFAULT_INTERVAL_##NAME = (INTERVAL),
+enum {
+    TASKS_X_LIST
+};
+#undef TASKS_X
+
+#define TASKS_TDMA_X(NAME, PHASE, SLOT) \
+    _Static_assert( \
+        (PHASE) < (SLOT) && (PHASE) + (SLOT) * (CELLBOARD_COUNT) <= TASKS_DEFAULT_INTERVAL_##NAME, \
+        "the time slots of the " #NAME " task do not fit inside its interval" \
+    );
+TASKS_TDMA_X_LIST
+#undef TASKS_TDMA_X
+
+/**
+ * @brief Get the start of a task inside the time slot of the cellboard
+ *
+ * @details The phase and the slot width are scaled by the ratio between the
+ * given interval and the default one, so that the slots of all the cellboards
+ * always fit inside the interval of the task
+ *
+ * @param id The task identifier
+ * @param interval The interval of the task in ms
+ *
+ * @return ticks_t The start of the task, unchanged if the task has no time slot
+ */
+_STATIC_INLINE ticks_t _tasks_tdma_get_start(const TasksId id, const milliseconds_t interval) {
+    const uint32_t cellboard_id = identity_get_cellboard_id();
+    switch (id) {
+#define TASKS_TDMA_X(NAME, PHASE, SLOT) \
+        case TASKS_NAME_TO_ID(NAME): \
+            return TASKS_DEFAULT_START_##NAME + TIMEBASE_MS_TO_TICKS( \
+                ((PHASE) + (SLOT) * cellboard_id) * (uint32_t)interval / TASKS_DEFAULT_INTERVAL_##NAME, \
+                htasks.resolution \
+            );
+        TASKS_TDMA_X_LIST
+#undef TASKS_TDMA_X
+        default:
+            return htasks.tasks[id].start;
+    }
+}
+
+#endif // CONF_TASKS_TDMA_ENABLE
+
 /** @brief Send the current FSM status via CAN */
 void _tasks_send_status(void) {
     size_t byte_size = 0U;
@@ -67,6 +116,9 @@ void _tasks_send_errors(void) {
 void _tasks_send_voltages(void) {
     size_t byte_size = 0U;
     const uint8_t * const payload = (const uint8_t * const)volt_get_canlib_payload(&byte_size);
+    // Nothing changed since the last transmission
+    if (payload == NULL)
+        return;
     can_comm_tx_add(
         BMS_CELLBOARD_CELLS_VOLTAGE_INDEX,
         CAN_FRAME_TYPE_DATA,
@@ -79,6 +131,9 @@ void _tasks_send_voltages(void) {
 void _tasks_send_temperatures(void) {
     size_t byte_size = 0U;
     const uint8_t * const payload = (const uint8_t * const)temp_get_cells_temp_canlib_payload(&byte_size);
+    // Nothing changed since the last transmission
+    if (payload == NULL)
+        return;
     can_comm_tx_add(
         BMS_CELLBOARD_CELLS_TEMPERATURE_INDEX,
         CAN_FRAME_TYPE_DATA,
@@ -119,19 +174,25 @@ void _tasks_read_temperatures(void) {
 /** @brief Run the bms manager procedures */
 void _tasks_run_bms_manager(void) {
     bms_manager_routine();
+
+    // Send the remaining groups of voltages updated by the last read
+    tasks_publish_voltages();
 }
 
 TasksReturnCode tasks_init(milliseconds_t resolution) {
     if (resolution == 0U)
         resolution = 1U;
     memset(&htasks, 0U, sizeof(htasks));
+    htasks.resolution = resolution;
 
     // Initialize the tasks with the X macro
-#define TASKS_X(NAME, ENABLED, START, INTERVAL, EXEC) \
+#define TASKS_X(NAME, ENABLED, START, INTERVAL, PRIORITY, POLICY, EXEC) \
     do { \
         htasks.tasks[TASKS_NAME_TO_ID(NAME)].id = TASKS_NAME_TO_ID(NAME); \
         htasks.tasks[TASKS_NAME_TO_ID(NAME)].start = (START); \
         htasks.tasks[TASKS_NAME_TO_ID(NAME)].interval = TIMEBASE_MS_TO_TICKS(INTERVAL, resolution); \
+        htasks.tasks[TASKS_NAME_TO_ID(NAME)].priority = TASKS_NAME_TO_PRIORITY(PRIORITY); \
+        htasks.tasks[TASKS_NAME_TO_ID(NAME)].policy = TASKS_NAME_TO_POLICY(POLICY); \
         htasks.tasks[TASKS_NAME_TO_ID(NAME)].exec = (EXEC); \
         htasks.tasks[TASKS_NAME_TO_ID(NAME)].enabled = (ENABLED); \
     } while(0U);
@@ -139,6 +200,15 @@ TasksReturnCode tasks_init(milliseconds_t resolution) {
     TASKS_X_LIST
 #undef TASKS_X
 
+#ifdef CONF_TASKS_TDMA_ENABLE
+    // Move the telemetry tasks inside the time slot of the cellboard
+#define TASKS_TDMA_X(NAME, PHASE, SLOT) \
+    htasks.tasks[TASKS_NAME_TO_ID(NAME)].start = _tasks_tdma_get_start(TASKS_NAME_TO_ID(NAME), TASKS_DEFAULT_INTERVAL_##NAME);
+
+    TASKS_TDMA_X_LIST
+#undef TASKS_TDMA_X
+#endif // CONF_TASKS_TDMA_ENABLE
+
     return TASKS_OK;
 }
 
@@ -179,19 +249,56 @@ bool tasks_is_enabled(const TasksId id) {
     return htasks.tasks[id].enabled;
 }
 
+TasksReturnCode tasks_set_interval(const TasksId id, const milliseconds_t interval) {
+    if (id >= TASKS_ID_COUNT)
+        return TASKS_INVALID_ID;
+    if (interval < TASKS_INTERVAL_MIN_MS || interval > TASKS_INTERVAL_MAX_MS)
+        return TASKS_INVALID_INTERVAL;
+    htasks.tasks[id].interval = TIMEBASE_MS_TO_TICKS(interval, htasks.resolution);
+#ifdef CONF_TASKS_TDMA_ENABLE
+    // The time slots are scaled so that they still fit inside the new interval
+    htasks.tasks[id].start = _tasks_tdma_get_start(id, interval);
+#endif // CONF_TASKS_TDMA_ENABLE
+    (void)timebase_reschedule_task(id);
+    return TASKS_OK;
+}
+
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+void tasks_publish_voltages(void) {
+    // The groups share the same mailbox so only one can wait to be sent at a time
+    if (can_comm_tx_is_pending(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX))
+        return;
+
+    size_t byte_size = 0U;
+    const uint8_t * const payload = (const uint8_t * const)volt_get_updated_canlib_payload(&byte_size);
+    if (payload == NULL)
+        return;
+    can_comm_tx_add(
+        BMS_CELLBOARD_CELLS_VOLTAGE_INDEX,
+        CAN_FRAME_TYPE_DATA,
+        payload,
+        byte_size
+    );
+}
+
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
 #ifdef CONF_TASKS_STRINGS_ENABLE
 
 _STATIC char * tasks_module_name = "tasks";
 
 _STATIC char * tasks_return_code_name[] = {
-    [TASKS_OK] = "ok"
+    [TASKS_OK] = "ok",
+    [TASKS_INVALID_INTERVAL] = "invalid interval"
 };
 
 _STATIC char * tasks_return_code_descritpion[] = {
-    [TASKS_OK] = "executed successfully"
+    [TASKS_OK] = "executed successfully",
+    [TASKS_INVALID_INTERVAL] = "the interval is outside of the allowed limits"
 };
 
-#define TASKS_X(NAME, START, INTERVAL, EXEC) [TASKS_NAME_TO_ID(NAME)] = #NAME,
+#define TASKS_X(NAME, ENABLED, START, INTERVAL, PRIORITY, POLICY, EXEC) [TASKS_NAME_TO_ID(NAME)] = #NAME,
 _STATIC char * tasks_id_name[] = {
     TASKS_X_LIST
 };
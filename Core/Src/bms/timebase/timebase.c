@@ -14,6 +14,254 @@
 
 _STATIC _TimebaseHandler htimebase;
 
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+
+/**
+ * @brief Update the execution time statistics of a task
+ *
+ * @param task A pointer to the executed task
+ * @param dt The execution time in profiler clock counts
+ */
+_STATIC_INLINE void _timebase_profiler_update(const Task * const task, const uint32_t dt) {
+    TimebaseTaskProfile * const profile = &htimebase.profiles[task->id];
+    ++profile->count;
+    profile->total += dt;
+    profile->min = CELLBOARD_MIN(profile->min, dt);
+    profile->max = CELLBOARD_MAX(profile->max, dt);
+
+    // The task overruns if it lasts longer than its interval
+    const uint64_t interval = (uint64_t)TIMEBASE_TICKS_TO_MS(task->interval, htimebase.resolution) *
+        (TIMEBASE_PROFILER_CLOCK_FREQUENCY_HZ / 1000U);
+    if (task->interval > 0U && dt > interval)
+        ++profile->overruns;
+}
+
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+
+/**
+ * @brief Execute a single task
+ *
+ * @details If the profiler is enabled the execution time of the task is measured
+ *
+ * @param task A pointer to the task to execute
+ */
+_STATIC_INLINE void _timebase_task_exec(const Task * const task) {
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+    if (htimebase.profiler_clock_get != NULL) {
+        const uint32_t start = htimebase.profiler_clock_get();
+        task->exec();
+        _timebase_profiler_update(task, htimebase.profiler_clock_get() - start);
+        return;
+    }
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+    task->exec();
+}
+
+/**
+ * @brief Update the release jitter statistics of a task
+ *
+ * @param id The identifier of the task
+ * @param delay The number of ticks elapsed between the deadline and the execution of the task
+ */
+_STATIC_INLINE void _timebase_jitter_update(const TasksId id, ticks_t delay) {
+    TimebaseTaskJitter * const jitter = &htimebase.jitter[id];
+    jitter->max = CELLBOARD_MAX(jitter->max, delay);
+
+    // Get the bin from the number of significant bits of the delay
+    size_t bin = 0U;
+    for (; delay > 0U && bin < TIMEBASE_JITTER_BIN_COUNT - 1U; delay >>= 1U)
+        ++bin;
+    ++jitter->bins[bin];
+}
+
+/**
+ * @brief Execute a task whose deadline has elapsed and get its next deadline
+ *
+ * @details The next deadline is computed from the previous one and not from the
+ * current time to avoid drifting when the task is executed late
+ * If one or more of the following deadlines have already elapsed they are
+ * either recovered or skipped depending on the task policy, the skipped
+ * deadlines are always a multiple of the interval so the phase is kept
+ *
+ * @param task A pointer to the task
+ * @param deadline The deadline of the task
+ * @param t The current time
+ *
+ * @return ticks_t The next deadline of the task
+ */
+_STATIC_INLINE ticks_t _timebase_task_release(const Task * const task, const ticks_t deadline, const ticks_t t) {
+    if (task->enabled) {
+        _timebase_jitter_update(task->id, t - deadline);
+        _timebase_task_exec(task);
+    }
+
+    const ticks_t next = deadline + task->interval;
+    if (task->interval == 0U || next > t)
+        return next;
+
+    // Skip the elapsed deadlines if the task should not, or can't, catch up
+    const ticks_t missed = (t - deadline) / task->interval;
+    if (task->policy == TASKS_POLICY_CATCH_UP && missed <= TIMEBASE_CATCH_UP_MAX_RELEASES)
+        return next;
+    if (task->enabled)
+        htimebase.jitter[task->id].skipped += missed;
+    return next + missed * task->interval;
+}
+
+/**
+ * @brief Get the deadline of a task after its interval was changed
+ *
+ * @details Without the TDMA slots the task is only moved earlier, so that it
+ * is released no later than one interval from now
+ * @details With the TDMA slots the task is moved to the first deadline after
+ * the current time that is a multiple of the interval from its start, so that
+ * every cellboard falls back inside its own slot whenever the interval is changed
+ *
+ * @param task A pointer to the task
+ * @param deadline The current deadline of the task
+ *
+ * @return ticks_t The new deadline of the task
+ */
+_STATIC_INLINE ticks_t _timebase_tasks_get_new_deadline(const Task * const task, const ticks_t deadline) {
+#ifdef CONF_TASKS_TDMA_ENABLE
+    if (task->interval == 0U)
+        return deadline;
+    if (task->start > htimebase.t)
+        return task->start;
+    return htimebase.t + task->interval - (htimebase.t - task->start) % task->interval;
+#else  // CONF_TASKS_TDMA_ENABLE
+    return CELLBOARD_MIN(htimebase.t + task->interval, deadline);
+#endif // CONF_TASKS_TDMA_ENABLE
+}
+
+#ifdef CONF_TIMEBASE_WHEEL_ENABLE
+
+// The slots are stored as bitmasks so a task identifier must fit inside it
+_Static_assert(TASKS_COUNT <= (sizeof(bit_flag32_t) * 8U), "too many tasks for the timing wheel slots");
+
+/**
+ * @brief Schedule a task inside a timing wheel
+ *
+ * @param wheel A pointer to the timing wheel
+ * @param id The identifier of the task
+ * @param t The time in which the task should be executed
+ */
+_STATIC_INLINE void _timebase_wheel_schedule(TimebaseTasksWheel * const wheel, const TasksId id, const ticks_t t) {
+    const size_t slot = TIMEBASE_WHEEL_SLOT(t);
+    wheel->deadline[id] = t;
+    wheel->slots[slot] = CELLBOARD_BIT_SET(wheel->slots[slot], id);
+}
+
+/**
+ * @brief Initialize the timing wheels with the start time of each task
+ *
+ * @details Each task is scheduled inside the wheel of its priority
+ */
+_STATIC_INLINE void _timebase_tasks_init(void) {
+    for (size_t i = 0U; i < TASKS_COUNT; ++i) {
+        const Task * const task = tasks_get_task(i);
+        _timebase_wheel_schedule(&htimebase.scheduled_tasks[task->priority], (TasksId)i, task->start);
+    }
+}
+
+/**
+ * @brief Execute the tasks of a single priority which deadline has already elapsed
+ *
+ * @details Every tick elapsed since the last call is processed in order, and
+ * only the tasks stored in the corresponding slot are checked
+ * If the budget is exhausted the wheel stops in the current slot and the
+ * remaining tasks are executed on the next call
+ *
+ * @param priority The priority of the tasks to execute
+ * @param budget The maximum number of tasks that can be executed
+ *
+ * @return size_t The budget left after the execution of the tasks
+ */
+_STATIC_INLINE size_t _timebase_tasks_dispatch(const TasksPriority priority, size_t budget) {
+    TimebaseTasksWheel * const wheel = &htimebase.scheduled_tasks[priority];
+
+    while (wheel->t <= htimebase.t) {
+        const size_t slot = TIMEBASE_WHEEL_SLOT(wheel->t);
+
+        // Tasks re-scheduled inside the same slot are handled on the next revolution
+        bit_flag32_t pending = wheel->slots[slot];
+        while (pending != 0U) {
+            const TasksId id = (TasksId)__builtin_ctz(pending);
+            pending &= pending - 1U;
+
+            // Skip tasks that belongs to one of the next revolutions
+            if (wheel->deadline[id] > wheel->t)
+                continue;
+
+            // Defer the remaining tasks if the budget is exhausted
+            Task * const task = tasks_get_task(id);
+            if (task->enabled) {
+                if (budget == 0U)
+                    return 0U;
+                --budget;
+            }
+            wheel->slots[slot] = CELLBOARD_BIT_RESET(wheel->slots[slot], id);
+
+            // Copy ticks value to avoid inconsistencies caused by interrupts
+            const ticks_t t = htimebase.t;
+            const ticks_t next = _timebase_task_release(task, wheel->deadline[id], t);
+
+            // If the interval is 0 do not schedule the task again (i.e. runs only once)
+            if (task->interval > 0U)
+                _timebase_wheel_schedule(wheel, id, next);
+        }
+        ++wheel->t;
+    }
+    return budget;
+}
+
+/**
+ * @brief Get the earliest deadline of the enabled tasks
+ *
+ * @param t A pointer where the deadline is stored
+ *
+ * @return bool True if at least one enabled task is scheduled, false otherwise
+ */
+_STATIC_INLINE bool _timebase_tasks_next_deadline(ticks_t * const t) {
+    bool found = false;
+    for (size_t i = 0U; i < TASKS_COUNT; ++i) {
+        const Task * const task = tasks_get_task(i);
+        const TimebaseTasksWheel * const wheel = &htimebase.scheduled_tasks[task->priority];
+        const ticks_t deadline = wheel->deadline[i];
+        if (!task->enabled || !CELLBOARD_BIT_GET(wheel->slots[TIMEBASE_WHEEL_SLOT(deadline)], i))
+            continue;
+        if (!found || deadline < *t)
+            *t = deadline;
+        found = true;
+    }
+    return found;
+}
+
+/**
+ * @brief Move a task to a new deadline after its interval was changed
+ *
+ * @details A task that is not scheduled (i.e. it is being executed or it runs
+ * only once) is left untouched because its next deadline is calculated after
+ * the release
+ *
+ * @param task A pointer to the task
+ */
+_STATIC_INLINE void _timebase_tasks_reschedule(const Task * const task) {
+    TimebaseTasksWheel * const wheel = &htimebase.scheduled_tasks[task->priority];
+    const ticks_t deadline = wheel->deadline[task->id];
+    const size_t slot = TIMEBASE_WHEEL_SLOT(deadline);
+    if (!CELLBOARD_BIT_GET(wheel->slots[slot], task->id))
+        return;
+
+    const ticks_t next = _timebase_tasks_get_new_deadline(task, deadline);
+    if (next == deadline)
+        return;
+    wheel->slots[slot] = CELLBOARD_BIT_RESET(wheel->slots[slot], task->id);
+    _timebase_wheel_schedule(wheel, task->id, next);
+}
+
+#else  // CONF_TIMEBASE_WHEEL_ENABLE
+
 int8_t _timebase_task_compare(void * a, void * b) {
     const TimebaseScheduledTask * const f = (TimebaseScheduledTask *)a;
     const TimebaseScheduledTask * const s = (TimebaseScheduledTask *)b;
@@ -33,51 +281,246 @@ int8_t _timebase_task_compare(void * a, void * b) {
     return 1;
 }
 
-int8_t _timebase_watchdog_compare(void * a, void * b) {
-    const TimebaseScheduledWatchdog * f = (TimebaseScheduledWatchdog *)a;
-    const TimebaseScheduledWatchdog * s = (TimebaseScheduledWatchdog *)b;
+/**
+ * @brief Initialize the heaps with the start time of each task
+ *
+ * @details Each task is inserted inside the heap of its priority
+ */
+_STATIC_INLINE void _timebase_tasks_init(void) {
+    for (size_t i = 0; i < TASKS_PRIORITY_COUNT; ++i)
+        (void)min_heap_init(&htimebase.scheduled_tasks[i], TimebaseScheduledTask, TASKS_COUNT, _timebase_task_compare);
+    for (size_t i = 0; i < TASKS_COUNT; ++i) {
+        TimebaseScheduledTask aux = {
+            .t = tasks_get_start(i),
+            .task = tasks_get_task(i)
+        };
+        (void)min_heap_insert(&htimebase.scheduled_tasks[aux.task->priority], &aux);
+    }
+}
+
+/**
+ * @brief Execute the tasks of a single priority which deadline has already elapsed
+ *
+ * @details If the budget is exhausted the remaining tasks are executed on the next call
+ *
+ * @param priority The priority of the tasks to execute
+ * @param budget The maximum number of tasks that can be executed
+ *
+ * @return size_t The budget left after the execution of the tasks
+ */
+_STATIC_INLINE size_t _timebase_tasks_dispatch(const TasksPriority priority, size_t budget) {
+    TimebaseScheduledTask * task_p = (TimebaseScheduledTask *)min_heap_peek(&htimebase.scheduled_tasks[priority]);
+    while (task_p != NULL && task_p->t <= htimebase.t) {
+        // Defer the remaining tasks if the budget is exhausted
+        if (task_p->task->enabled) {
+            if (budget == 0U)
+                return 0U;
+            --budget;
+        }
 
-    /**************************************************************************
-     * For the equality check, only the pointers to the watchdogs are checked
-     * This can cause problems if multiple instances of the same watchdog are
-     * inserted in the heap, but in this case a watchdog can be inserted inside
-     * the heap only once
-     ***************************************************************************/
-    if (f->watchdog == s->watchdog)
-        return 0;
+        // Get and execute current task
+        TimebaseScheduledTask task = { 0 };
+        (void)min_heap_remove(&htimebase.scheduled_tasks[priority], 0U, &task);
 
-    // Compare timestamps
-    if (f->t < s->t) return -1;
-    return f->t == s->t ? 0 : 1;
+        // Copy ticks value to avoid inconsistencies caused by interrupts
+        const ticks_t t = htimebase.t;
+        task.t = _timebase_task_release(task.task, task.t, t);
+
+        // If the interval is 0 do not insert again the task inside the heap (i.e. runs only once)
+        if (task.task->interval > 0U)
+            (void)min_heap_insert(&htimebase.scheduled_tasks[priority], &task);
+
+        task_p = (TimebaseScheduledTask *)min_heap_peek(&htimebase.scheduled_tasks[priority]);
+    }
+    return budget;
 }
 
-TimebaseReturnCode timebase_init(const milliseconds_t resolution_ms) {
+/**
+ * @brief Get the earliest deadline of the enabled tasks
+ *
+ * @details The disabled tasks are kept inside the heaps so every scheduled
+ * task is checked instead of only the top of each heap
+ *
+ * @param t A pointer where the deadline is stored
+ *
+ * @return bool True if at least one enabled task is scheduled, false otherwise
+ */
+_STATIC_INLINE bool _timebase_tasks_next_deadline(ticks_t * const t) {
+    bool found = false;
+    for (size_t i = 0U; i < TASKS_PRIORITY_COUNT; ++i) {
+        const size_t size = min_heap_size(&htimebase.scheduled_tasks[i]);
+        for (size_t j = 0U; j < size; ++j) {
+            const TimebaseScheduledTask * const task_p = &htimebase.scheduled_tasks[i].data[j];
+            if (!task_p->task->enabled)
+                continue;
+            if (!found || task_p->t < *t)
+                *t = task_p->t;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Move a task to a new deadline after its interval was changed
+ *
+ * @details A task that is not scheduled (i.e. it is being executed or it runs
+ * only once) is left untouched because its next deadline is calculated after
+ * the release
+ *
+ * @param task A pointer to the task
+ */
+_STATIC_INLINE void _timebase_tasks_reschedule(const Task * const task) {
+    void * const heap = &htimebase.scheduled_tasks[task->priority];
+    const size_t size = min_heap_size(heap);
+    for (size_t i = 0U; i < size; ++i) {
+        if (htimebase.scheduled_tasks[task->priority].data[i].task != task)
+            continue;
+
+        const ticks_t next = _timebase_tasks_get_new_deadline(task, htimebase.scheduled_tasks[task->priority].data[i].t);
+        if (next == htimebase.scheduled_tasks[task->priority].data[i].t)
+            return;
+        TimebaseScheduledTask aux = { 0 };
+        (void)min_heap_remove(heap, i, &aux);
+        aux.t = next;
+        (void)min_heap_insert(heap, &aux);
+        return;
+    }
+}
+
+#endif // CONF_TIMEBASE_WHEEL_ENABLE
+
+/**
+ * @brief Update the current time with the ticks elapsed according to the clock
+ *
+ * @details Only whole ticks are added to the current time, the remaining
+ * counts are kept for the next update
+ */
+_STATIC_INLINE void _timebase_clock_update(void) {
+    if (htimebase.clock_get == NULL)
+        return;
+    const uint32_t counter = htimebase.clock_get();
+    const uint32_t ticks = (counter - htimebase.counter) / htimebase.counts_per_tick;
+    htimebase.counter += ticks * htimebase.counts_per_tick;
+    htimebase.t += ticks;
+}
+
+/**
+ * @brief Set the clock alarm for the next deadline
+ *
+ * @details If some tasks were deferred the alarm is set to the current time
+ * so that it triggers immediately
+ */
+_STATIC_INLINE void _timebase_clock_set_alarm(void) {
+    if (htimebase.clock_set_alarm == NULL)
+        return;
+    const ticks_t t = htimebase.t;
+    const ticks_t deadline = timebase_get_next_deadline();
+    const ticks_t dt = (deadline > t) ? (deadline - t) : 0U;
+    htimebase.clock_set_alarm(htimebase.counter + dt * htimebase.counts_per_tick);
+}
+
+/**
+ * @brief Place a scheduled watchdog at the given position of the heap
+ *
+ * @details The position is stored inside the watchdog to avoid searching for it
+ *
+ * @param i The index of the position inside the heap
+ * @param item The scheduled watchdog to place
+ */
+_STATIC_INLINE void _timebase_watchdog_place(const size_t i, const TimebaseScheduledWatchdog item) {
+    htimebase.scheduled_watchdogs.data[i] = item;
+    item.watchdog->slot = i + 1U;
+}
+
+/**
+ * @brief Move a scheduled watchdog towards the root of the heap until its parent expires earlier
+ *
+ * @param i The index of the watchdog inside the heap
+ */
+_STATIC_INLINE void _timebase_watchdog_sift_up(size_t i) {
+    TimebaseWatchdogHeap * const heap = &htimebase.scheduled_watchdogs;
+    const TimebaseScheduledWatchdog item = heap->data[i];
+    while (i > 0U) {
+        const size_t parent = (i - 1U) / 2U;
+        if (heap->data[parent].t <= item.t)
+            break;
+        _timebase_watchdog_place(i, heap->data[parent]);
+        i = parent;
+    }
+    _timebase_watchdog_place(i, item);
+}
+
+/**
+ * @brief Move a scheduled watchdog towards the leaves of the heap until its children expires later
+ *
+ * @param i The index of the watchdog inside the heap
+ */
+_STATIC_INLINE void _timebase_watchdog_sift_down(size_t i) {
+    TimebaseWatchdogHeap * const heap = &htimebase.scheduled_watchdogs;
+    const TimebaseScheduledWatchdog item = heap->data[i];
+    for (size_t child = 2U * i + 1U; child < heap->size; child = 2U * i + 1U) {
+        // Get the child that expires first
+        if (child + 1U < heap->size && heap->data[child + 1U].t < heap->data[child].t)
+            ++child;
+        if (item.t <= heap->data[child].t)
+            break;
+        _timebase_watchdog_place(i, heap->data[child]);
+        i = child;
+    }
+    _timebase_watchdog_place(i, item);
+}
+
+/**
+ * @brief Remove a scheduled watchdog from the heap
+ *
+ * @param i The index of the watchdog inside the heap
+ */
+_STATIC_INLINE void _timebase_watchdog_remove(const size_t i) {
+    TimebaseWatchdogHeap * const heap = &htimebase.scheduled_watchdogs;
+    heap->data[i].watchdog->slot = 0U;
+
+    // Replace the removed watchdog with the last one and restore the heap order
+    --heap->size;
+    if (i == heap->size)
+        return;
+    _timebase_watchdog_place(i, heap->data[heap->size]);
+    if (i > 0U && heap->data[i].t < heap->data[(i - 1U) / 2U].t)
+        _timebase_watchdog_sift_up(i);
+    else
+        _timebase_watchdog_sift_down(i);
+}
+
+TimebaseReturnCode timebase_init(
+    const milliseconds_t resolution_ms,
+    const timebase_clock_get_callback_t clock_get,
+    const timebase_clock_set_alarm_callback_t clock_set_alarm)
+{
+    if ((clock_get == NULL) != (clock_set_alarm == NULL))
+        return TIMEBASE_NULL_POINTER;
+
     // Initialize timebase to 0
     memset(&htimebase, 0U, sizeof(htimebase));
 
     // Set default parameters
     htimebase.enabled = false;
     htimebase.resolution = (resolution_ms == 0U) ? 1U : resolution_ms;
+    htimebase.clock_get = clock_get;
+    htimebase.clock_set_alarm = clock_set_alarm;
+    htimebase.counts_per_tick = (TIMEBASE_CLOCK_FREQUENCY_HZ / 1000U) * htimebase.resolution;
 
     // Initialize the tasks
     (void)tasks_init(resolution_ms);
 
-    // Initialize the tasks heap
-    (void)min_heap_init(&htimebase.scheduled_tasks, TimebaseScheduledTask, TASKS_COUNT, _timebase_task_compare);
-    for (size_t i = 0; i < TASKS_COUNT; ++i) {
-        TimebaseScheduledTask aux = {
-            .t = tasks_get_start(i),
-            .task = tasks_get_task(i)
-        };
-        (void)min_heap_insert(&htimebase.scheduled_tasks, &aux);
-    }
-
-    // Initialize the watchdogs heap
-    (void)min_heap_init(&htimebase.scheduled_watchdogs, TimebaseScheduledWatchdog, TIMEBASE_RUNNING_WATCHDOG_COUNT, _timebase_watchdog_compare);
+    // Schedule the tasks
+    _timebase_tasks_init();
     return TIMEBASE_OK;
 }
 
 void timebase_set_enable(const bool enabled) {
+    // Ignore the time elapsed while the timebase was disabled
+    if (enabled && !htimebase.enabled && htimebase.clock_get != NULL)
+        htimebase.counter = htimebase.clock_get();
     htimebase.enabled = enabled;
 }
 
@@ -100,36 +543,43 @@ milliseconds_t timebase_get_resolution(void) {
     return htimebase.resolution;
 }
 
+ticks_t timebase_get_next_deadline(void) {
+    const ticks_t t = htimebase.t;
+    ticks_t deadline = t + TIMEBASE_MS_TO_TICKS(TIMEBASE_CLOCK_MAX_IDLE_MS, htimebase.resolution);
+
+    ticks_t task_deadline = 0U;
+    if (_timebase_tasks_next_deadline(&task_deadline))
+        deadline = CELLBOARD_MIN(deadline, task_deadline);
+    if (htimebase.scheduled_watchdogs.size > 0U)
+        deadline = CELLBOARD_MIN(deadline, htimebase.scheduled_watchdogs.data[0U].t);
+    return deadline;
+}
+
 TimebaseReturnCode timebase_register_watchdog(Watchdog * const watchdog) {
     if (watchdog == NULL)
         return TIMEBASE_NULL_POINTER;
+    if (timebase_is_registered_watchdog(watchdog))
+        return TIMEBASE_BUSY;
+    if (htimebase.scheduled_watchdogs.size >= TIMEBASE_RUNNING_WATCHDOG_COUNT)
+        return TIMEBASE_WATCHDOG_UNAVAILABLE;
 
-    TimebaseScheduledWatchdog aux = {
-        .t = 0U,
+    // Insert the watchdog as the last leaf of the heap
+    const TimebaseScheduledWatchdog aux = {
+        .t = htimebase.t + watchdog->timeout,
         .watchdog = watchdog
     };
-    if (min_heap_find(&htimebase.scheduled_watchdogs, &aux) >= 0)
-        return TIMEBASE_BUSY;
-
-    aux.t = htimebase.t + watchdog->timeout;
-    if (min_heap_insert(&htimebase.scheduled_watchdogs, &aux) == MIN_HEAP_FULL)
-        return TIMEBASE_WATCHDOG_UNAVAILABLE;
+    const size_t i = htimebase.scheduled_watchdogs.size++;
+    _timebase_watchdog_place(i, aux);
+    _timebase_watchdog_sift_up(i);
     return TIMEBASE_OK;
 }
 
 TimebaseReturnCode timebase_unregister_watchdog(Watchdog * const watchdog) {
     if (watchdog == NULL)
         return TIMEBASE_NULL_POINTER;
-    
-    // Get and remove the running watchdog from the heap
-    TimebaseScheduledWatchdog aux = {
-        .t = 0U,
-        .watchdog = watchdog
-    };
-    const signed_size_t i = min_heap_find(&htimebase.scheduled_watchdogs, &aux);
-    if (i < 0)
+    if (!timebase_is_registered_watchdog(watchdog))
         return TIMEBASE_WATCHDOG_NOT_REGISTERED;
-    (void)min_heap_remove(&htimebase.scheduled_watchdogs, i, NULL);
+    _timebase_watchdog_remove(watchdog->slot - 1U);
     return TIMEBASE_OK;
 }
 
@@ -137,35 +587,39 @@ bool timebase_is_registered_watchdog(Watchdog * const watchdog) {
     if (watchdog == NULL)
         return false;
 
-    // Get the running watchdog
-    TimebaseScheduledWatchdog aux = {
-        .t = 0U,
-        .watchdog = watchdog
-    };
-    return min_heap_find(&htimebase.scheduled_watchdogs, &aux) >= 0;
+    /**************************************************************************
+     * The stored position is checked against the heap content because the
+     * timebase can be re-initialized while the watchdog is still holding it
+     ***************************************************************************/
+    const size_t slot = watchdog->slot;
+    return slot > 0U &&
+        slot <= htimebase.scheduled_watchdogs.size &&
+        htimebase.scheduled_watchdogs.data[slot - 1U].watchdog == watchdog;
 }
 
 TimebaseReturnCode timebase_update_watchdog(Watchdog * const watchdog) {
     if (watchdog == NULL)
         return TIMEBASE_NULL_POINTER;
-
-    // Get the running watchdog
-    TimebaseScheduledWatchdog aux = {
-        .t = 0U,
-        .watchdog = watchdog
-    };
-    const signed_size_t i = min_heap_find(&htimebase.scheduled_watchdogs, &aux);
-    // Remove, update and re-insert the item in the heap
-    if (i < 0)
+    if (!timebase_is_registered_watchdog(watchdog))
         return TIMEBASE_WATCHDOG_NOT_REGISTERED;
 
-    (void)min_heap_remove(&htimebase.scheduled_watchdogs, i, NULL);
-    
-    aux.t = htimebase.t + watchdog->timeout;
-    if (min_heap_insert(&htimebase.scheduled_watchdogs, &aux) == MIN_HEAP_FULL)
-        return TIMEBASE_WATCHDOG_UNAVAILABLE;
+    // The timeout can only be postponed so the watchdog can only move towards the leaves
+    const size_t i = watchdog->slot - 1U;
+    htimebase.scheduled_watchdogs.data[i].t = htimebase.t + watchdog->timeout;
+    _timebase_watchdog_sift_down(i);
     return TIMEBASE_OK;
+}
+
+TimebaseReturnCode timebase_reschedule_task(const TasksId id) {
+    const Task * const task = tasks_get_task(id);
+    if (task == NULL)
+        return TIMEBASE_NULL_POINTER;
+    _timebase_tasks_reschedule(task);
 
+    // The alarm could be set after the new deadline
+    if (htimebase.enabled)
+        _timebase_clock_set_alarm();
+    return TIMEBASE_OK;
 }
 
 // TODO: Check delta time between the right time?
@@ -173,41 +627,73 @@ TimebaseReturnCode timebase_routine(void) {
     if (!htimebase.enabled)
         return TIMEBASE_DISABLED;
 
-    // Execute all the tasks which interval has already elapsed
-    TimebaseScheduledTask * task_p = (TimebaseScheduledTask *)min_heap_peek(&htimebase.scheduled_tasks);
-    while (task_p != NULL && task_p->t <= htimebase.t) {
-        // Get and execute current task
-        TimebaseScheduledTask task = { 0 };
-        (void)min_heap_remove(&htimebase.scheduled_tasks, 0U, &task);
-
-        // Copy ticks value to avoid inconsistencies caused by interrupts
-        const ticks_t t = htimebase.t;
-        task.t = t + task.task->interval;
+    // Update the current time in tickless mode
+    _timebase_clock_update();
 
-        if (task.task->enabled)
-            task.task->exec();
-
-        // If the interval is 0 do not insert again the task inside the heap (i.e. runs only once)
-        if (task.task->interval > 0U)
-            (void)min_heap_insert(&htimebase.scheduled_tasks, &task);
-
-        task_p = (TimebaseScheduledTask *)min_heap_peek(&htimebase.scheduled_tasks);
-    } 
+    // Execute all the high priority tasks which interval has already elapsed
+    (void)_timebase_tasks_dispatch(TASKS_PRIORITY_HIGH, SIZE_MAX);
 
     // Check if the watchdogs has already timed-out
-    TimebaseScheduledWatchdog * wdg_p = (TimebaseScheduledWatchdog *)min_heap_peek(&htimebase.scheduled_watchdogs);
-    while (wdg_p != NULL && wdg_p->t <= htimebase.t) {
-        // Get the watchdog
-        TimebaseScheduledWatchdog wdg = { 0 };
-        (void)min_heap_remove(&htimebase.scheduled_watchdogs, 0U, &wdg);
+    TimebaseWatchdogHeap * const heap = &htimebase.scheduled_watchdogs;
+    while (heap->size > 0U && heap->data[0U].t <= htimebase.t) {
+        // Get and remove the watchdog
+        Watchdog * const watchdog = heap->data[0U].watchdog;
+        _timebase_watchdog_remove(0U);
 
         // Disable and execute the watchdog timeout callback
-        watchdog_timeout(wdg.watchdog);
-        wdg_p = (TimebaseScheduledWatchdog *)min_heap_peek(&htimebase.scheduled_watchdogs);
+        watchdog_timeout(watchdog);
     }
+
+    // Execute the other tasks until the budget is exhausted
+    size_t budget = TIMEBASE_ROUTINE_BUDGET;
+    for (size_t i = TASKS_PRIORITY_HIGH + 1U; i < TASKS_PRIORITY_COUNT; ++i)
+        budget = _timebase_tasks_dispatch((TasksPriority)i, budget);
+
+    // Wake up at the next deadline in tickless mode
+    _timebase_clock_set_alarm();
+    return TIMEBASE_OK;
+}
+
+const TimebaseTaskJitter * timebase_get_task_jitter(const TasksId id) {
+    if (id >= TASKS_COUNT)
+        return NULL;
+    return &htimebase.jitter[id];
+}
+
+void timebase_reset_jitter(void) {
+    memset(htimebase.jitter, 0U, sizeof(htimebase.jitter));
+}
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+
+TimebaseReturnCode timebase_profiler_init(const timebase_profiler_clock_get_callback_t clock_get) {
+    if (clock_get == NULL)
+        return TIMEBASE_NULL_POINTER;
+    htimebase.profiler_clock_get = clock_get;
+    timebase_profiler_reset();
     return TIMEBASE_OK;
 }
 
+void timebase_profiler_reset(void) {
+    memset(htimebase.profiles, 0U, sizeof(htimebase.profiles));
+    for (size_t i = 0U; i < TASKS_COUNT; ++i)
+        htimebase.profiles[i].min = UINT32_MAX;
+}
+
+const TimebaseTaskProfile * timebase_profiler_get_task(const TasksId id) {
+    if (id >= TASKS_COUNT)
+        return NULL;
+    return &htimebase.profiles[id];
+}
+
+uint32_t timebase_profiler_get_mean(const TasksId id) {
+    if (id >= TASKS_COUNT || htimebase.profiles[id].count == 0U)
+        return 0U;
+    return (uint32_t)(htimebase.profiles[id].total / htimebase.profiles[id].count);
+}
+
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+
 #ifdef CONF_TIMEBASE_STRINGS_ENABLE
 
 _STATIC char * timebase_module_name = "timebase";
@@ -40,9 +40,85 @@ _STATIC_INLINE void _volt_check_value(const size_t index, const volt_t value) {
         error_reset(ERROR_GROUP_OVER_VOLTAGE, index);
 }
 
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
+// The three voltages of the payload are scaled in the same way
+_Static_assert(
+    BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_1_MIN == BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MIN &&
+    BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_2_MIN == BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MIN &&
+    BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_1_MAX == BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MAX &&
+    BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_2_MAX == BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MAX &&
+    BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_1_BIT_SIZE == BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_BIT_SIZE &&
+    BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_2_BIT_SIZE == BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_BIT_SIZE,
+    "the voltages of the canlib payload must have the same range and size"
+);
+// The limits of the range must be exact in LTC units and the scaling must not overflow
+_Static_assert(
+    VOLT_CAN_RAW_MIN == (BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MIN) * 10000.0 &&
+    VOLT_CAN_RAW_MIN + VOLT_CAN_RAW_RANGE == (BMS_CELLBOARD_CELLS_VOLTAGE_VOLTAGE_0_MAX) * 10000.0,
+    "the range of the canlib voltages must be a multiple of the LTC resolution"
+);
+_Static_assert(
+    VOLT_CAN_RAW_MIN + VOLT_CAN_RAW_RANGE <= UINT16_MAX &&
+    VOLT_CAN_RAW_MAX <= UINT16_MAX &&
+    (uint64_t)VOLT_CAN_RAW_RANGE * VOLT_CAN_RAW_MAX <= UINT32_MAX,
+    "the scaling of the canlib voltages does not fit the integer types"
+);
+
+/**
+ * @brief Scale a raw voltage read from the LTC to the raw value of the canlib payload
+ *
+ * @details Values outside of the range of the payload are saturated
+ *
+ * @param value The raw voltage (100 uV per unit)
+ *
+ * @return uint16_t The scaled value
+ */
+_STATIC_INLINE uint16_t _volt_raw_to_canlib(const raw_volt_t value) {
+    if (value <= VOLT_CAN_RAW_MIN)
+        return 0U;
+    const uint32_t delta = CELLBOARD_MIN((uint32_t)value - VOLT_CAN_RAW_MIN, VOLT_CAN_RAW_RANGE);
+    return (uint16_t)((delta * VOLT_CAN_RAW_MAX) / VOLT_CAN_RAW_RANGE);
+}
+
+/**
+ * @brief Check that the integer scaling gives the same raw values of the canlib conversion
+ *
+ * @details Both conversions never decrease when the voltage increases, so
+ * besides the limits of the range it is enough to compare them at the first
+ * LTC code of every raw value of the payload and at the code right before it
+ *
+ * @return bool True if the conversions match for every voltage inside the range of the payload
+ */
+_STATIC bool _volt_check_raw_scaling(void) {
+    bms_cellboard_cells_voltage_converted_t conv = {
+        .voltage_0 = VOLT_RAW_TO_VOLT(VOLT_CAN_RAW_MIN),
+        .voltage_1 = VOLT_RAW_TO_VOLT(VOLT_CAN_RAW_MIN + VOLT_CAN_RAW_RANGE)
+    };
+    bms_cellboard_cells_voltage_t raw = { 0 };
+    bms_cellboard_cells_voltage_conversion_to_raw_struct(&raw, &conv);
+    if (raw.voltage_0 != 0U || raw.voltage_1 != VOLT_CAN_RAW_MAX)
+        return false;
+
+    for (uint32_t code = 1U; code <= VOLT_CAN_RAW_MAX; ++code) {
+        const raw_volt_t value = (raw_volt_t)(VOLT_CAN_RAW_MIN + (code * VOLT_CAN_RAW_RANGE + VOLT_CAN_RAW_MAX - 1U) / VOLT_CAN_RAW_MAX);
+        conv.voltage_0 = VOLT_RAW_TO_VOLT(value - 1U);
+        conv.voltage_1 = VOLT_RAW_TO_VOLT(value);
+        bms_cellboard_cells_voltage_conversion_to_raw_struct(&raw, &conv);
+        if (raw.voltage_0 != _volt_raw_to_canlib(value - 1U) || raw.voltage_1 != _volt_raw_to_canlib(value))
+            return false;
+    }
+    return true;
+}
+
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 VoltReturnCode volt_init(void) {
     memset(&hvolt, 0U, sizeof(hvolt));
     hvolt.voltages_can_payload.cellboard_id = (bms_cellboard_cells_voltage_cellboard_id)identity_get_cellboard_id();
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    hvolt.raw_scaling_exact = _volt_check_raw_scaling();
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
     return VOLT_OK;
 }
 
@@ -50,7 +126,13 @@ VoltReturnCode volt_update_value(const size_t index, const volt_t value) {
     if (index > CELLBOARD_SEGMENT_SERIES_COUNT)
         return VOLT_OUT_OF_BOUNDS;
     hvolt.voltages[index] = value;
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    hvolt.raw_voltages[index] = VOLT_VOLT_TO_RAW(value);
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
     _volt_check_value(index, value);
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+    hvolt.updated_groups = CELLBOARD_BIT_SET(hvolt.updated_groups, index / VOLT_CAN_GROUP_SIZE);
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
     return VOLT_OK;
 }
 
@@ -59,11 +141,33 @@ VoltReturnCode volt_update_values(const size_t index, const volt_t * const value
         return VOLT_OUT_OF_BOUNDS;
     for (size_t i = 0U; i < size; ++i) {
         hvolt.voltages[index + i] = values[i];
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+        hvolt.raw_voltages[index + i] = VOLT_VOLT_TO_RAW(values[i]);
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
         _volt_check_value(index + i, hvolt.voltages[index + i]);
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+        hvolt.updated_groups = CELLBOARD_BIT_SET(hvolt.updated_groups, (index + i) / VOLT_CAN_GROUP_SIZE);
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
     }
     return VOLT_OK;
 }
 
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
+VoltReturnCode volt_update_raw_value(const size_t index, const raw_volt_t value) {
+    if (index >= CELLBOARD_SEGMENT_SERIES_COUNT)
+        return VOLT_OUT_OF_BOUNDS;
+    hvolt.raw_voltages[index] = value;
+    hvolt.voltages[index] = VOLT_RAW_TO_VOLT(value);
+    _volt_check_value(index, hvolt.voltages[index]);
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+    hvolt.updated_groups = CELLBOARD_BIT_SET(hvolt.updated_groups, index / VOLT_CAN_GROUP_SIZE);
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+    return VOLT_OK;
+}
+
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 const cells_volt_t * volt_get_values(void) {
     return (const cells_volt_t *)&hvolt.voltages;
 }
@@ -98,7 +202,7 @@ volt_t volt_get_sum(void) {
 
 bit_flag32_t volt_select_values(const volt_t target) {
     bit_flag32_t bits = 0U;
-    CELLBOARD_ASSERT(CELLBOARD_SEGMENT_SERIES_COUNT > sizeof(bits) * 8U);
+    CELLBOARD_ASSERT(CELLBOARD_SEGMENT_SERIES_COUNT <= sizeof(bits) * 8U);
 
     // Iterate over cells and choose the one which voltage is greater than the target
     for (size_t i = 0U; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i) {
@@ -121,22 +225,136 @@ VoltReturnCode volt_dump_values(
     return VOLT_OK;
 }
 
-bms_cellboard_cells_voltage_converted_t * volt_get_canlib_payload(size_t * byte_size) {
-    if (byte_size != NULL)
-        *byte_size = sizeof(hvolt.voltages_can_payload);
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+/**
+ * @brief Check if a group of cells voltages has to be sent
+ *
+ * @param offset The index of the first cell of the group
+ * @param t The current time in ms
+ *
+ * @return bool True if a value moved outside the deadband or the refresh period expired
+ */
+_STATIC_INLINE bool _volt_is_group_changed(const size_t offset, const milliseconds_t t) {
+    const size_t group = offset / VOLT_CAN_GROUP_SIZE;
+    if (!CELLBOARD_BIT_GET(hvolt.sent_groups, group) || t - hvolt.sent_time[group] >= VOLT_REFRESH_MS)
+        return true;
+    for (size_t i = offset; i < offset + VOLT_CAN_GROUP_SIZE; ++i) {
+        const volt_t delta = hvolt.voltages[i] - hvolt.sent_voltages[i];
+        if (delta > VOLT_DEADBAND_V || delta < -VOLT_DEADBAND_V)
+            return true;
+    }
+    return false;
+}
+
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+/**
+ * @brief Copy a group of cells voltages into the canlib payload
+ *
+ * @param offset The index of the first cell of the group
+ * @param t The current time in ms
+ *
+ * @return volt_canlib_payload_t* A pointer to the payload
+ */
+_STATIC_INLINE volt_canlib_payload_t * _volt_fill_canlib_payload(const size_t offset, const milliseconds_t t) {
+    const size_t group = offset / VOLT_CAN_GROUP_SIZE;
+    hvolt.sent_time[group] = t;
+    hvolt.sent_groups = CELLBOARD_BIT_SET(hvolt.sent_groups, group);
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    memcpy(hvolt.sent_voltages + offset, hvolt.voltages + offset, VOLT_CAN_GROUP_SIZE * sizeof(hvolt.voltages[0U]));
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+    ++hvolt.sent_count;
 
-    _STATIC size_t offset = 0U;
     hvolt.voltages_can_payload.offset = offset;
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    if (hvolt.raw_scaling_exact) {
+        hvolt.voltages_can_payload.voltage_0 = _volt_raw_to_canlib(hvolt.raw_voltages[offset]);
+        hvolt.voltages_can_payload.voltage_1 = _volt_raw_to_canlib(hvolt.raw_voltages[offset + 1U]);
+        hvolt.voltages_can_payload.voltage_2 = _volt_raw_to_canlib(hvolt.raw_voltages[offset + 2U]);
+    }
+    else {
+        // Fall back to the canlib conversion so the values on the bus do not change
+        const bms_cellboard_cells_voltage_converted_t conv = {
+            .cellboard_id = (bms_cellboard_cells_voltage_cellboard_id)hvolt.voltages_can_payload.cellboard_id,
+            .offset = offset,
+            .voltage_0 = hvolt.voltages[offset],
+            .voltage_1 = hvolt.voltages[offset + 1U],
+            .voltage_2 = hvolt.voltages[offset + 2U]
+        };
+        bms_cellboard_cells_voltage_conversion_to_raw_struct(&hvolt.voltages_can_payload, &conv);
+    }
+#else  // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
     hvolt.voltages_can_payload.voltage_0 = hvolt.voltages[offset];
     hvolt.voltages_can_payload.voltage_1 = hvolt.voltages[offset + 1U];
     hvolt.voltages_can_payload.voltage_2 = hvolt.voltages[offset + 2U];
-
-    offset += 3U;
-    if (offset >= CELLBOARD_SEGMENT_SERIES_COUNT)
-        offset = 0U;
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
     return &hvolt.voltages_can_payload;
 }
 
+volt_canlib_payload_t * volt_get_canlib_payload(size_t * byte_size) {
+    if (byte_size != NULL)
+        *byte_size = sizeof(hvolt.voltages_can_payload);
+    const milliseconds_t t = timebase_get_time();
+
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    // Find the next group that has to be sent starting from the current offset
+    size_t i = 0U;
+    for (; i < VOLT_CAN_GROUP_COUNT && !_volt_is_group_changed(hvolt.offset, t); ++i) {
+        hvolt.offset += VOLT_CAN_GROUP_SIZE;
+        if (hvolt.offset >= CELLBOARD_SEGMENT_SERIES_COUNT)
+            hvolt.offset = 0U;
+    }
+    if (i >= VOLT_CAN_GROUP_COUNT) {
+        ++hvolt.saved_count;
+        return NULL;
+    }
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+    const size_t offset = hvolt.offset;
+    hvolt.offset += VOLT_CAN_GROUP_SIZE;
+    if (hvolt.offset >= CELLBOARD_SEGMENT_SERIES_COUNT)
+        hvolt.offset = 0U;
+    return _volt_fill_canlib_payload(offset, t);
+}
+
+#ifdef CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+volt_canlib_payload_t * volt_get_updated_canlib_payload(size_t * const byte_size) {
+    if (byte_size != NULL)
+        *byte_size = sizeof(hvolt.voltages_can_payload);
+    const milliseconds_t t = timebase_get_time();
+
+    for (size_t group = 0U; group < VOLT_CAN_GROUP_COUNT && hvolt.updated_groups != 0U; ++group) {
+        if (!CELLBOARD_BIT_GET(hvolt.updated_groups, group))
+            continue;
+        hvolt.updated_groups = CELLBOARD_BIT_RESET(hvolt.updated_groups, group);
+
+        // Limit the rate of each group to keep the same bus load of the periodic transmission
+        const size_t offset = group * VOLT_CAN_GROUP_SIZE;
+        if (CELLBOARD_BIT_GET(hvolt.sent_groups, group) && t - hvolt.sent_time[group] < VOLT_PUBLISH_INTERVAL_MS)
+            continue;
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+        if (!_volt_is_group_changed(offset, t)) {
+            ++hvolt.saved_count;
+            continue;
+        }
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+        return _volt_fill_canlib_payload(offset, t);
+    }
+    return NULL;
+}
+
+#endif // CONF_TELEMETRY_PUBLISH_ON_UPDATE_ENABLE
+
+uint32_t volt_get_sent_frame_count(void) {
+    return hvolt.sent_count;
+}
+
+uint32_t volt_get_saved_frame_count(void) {
+    return hvolt.saved_count;
+}
+
 #ifdef CONF_VOLTAGE_STRINGS_ENABLE
 
 _STATIC char * volt_module_name = "voltage";
@@ -23,6 +23,47 @@
 /* USER CODE BEGIN 0 */
 
 #include "bms_network.h"
+#include "idle.h"
+
+/** @brief Number of standard filter elements, each one accepts a single identifier */
+#define CAN_STD_FILTER_COUNT (3U)
+
+/**
+ * @brief Configure the acceptance filters so that only the messages handled
+ * by the cellboard are received
+ *
+ * @details Each filter accepts a single identifier so that the index of the
+ * matching filter can be used to get the message index without any lookup
+ *
+ * @details If the handled messages do not fit inside the filters every
+ * message is accepted and discarded by software instead
+ */
+void _can_config_filters(void) {
+    can_id_t ids[CAN_STD_FILTER_COUNT + 1U];
+    const size_t count = can_comm_get_rx_ids(ids, CAN_STD_FILTER_COUNT + 1U);
+
+    bool ok = count > 0U && count <= CAN_STD_FILTER_COUNT;
+    for (size_t i = 0U; ok && i < count; ++i) {
+        FDCAN_FilterTypeDef filter = {
+            .IdType = FDCAN_STANDARD_ID,
+            .FilterIndex = i,
+            .FilterType = FDCAN_FILTER_MASK,
+            .FilterConfig = FDCAN_FILTER_TO_RXFIFO0,
+            .FilterID1 = ids[i],
+            .FilterID2 = CAN_COMM_ID_MASK
+        };
+        ok = HAL_FDCAN_ConfigFilter(&HCAN_BMS, &filter) == HAL_OK;
+    }
+
+    // Messages that do not match any filter and remote frames never reach the RX FIFO
+    HAL_FDCAN_ConfigGlobalFilter(
+        &HCAN_BMS,
+        ok ? FDCAN_REJECT : FDCAN_ACCEPT_IN_RX_FIFO0,
+        FDCAN_REJECT,
+        FDCAN_REJECT_REMOTE,
+        FDCAN_REJECT_REMOTE
+    );
+}
 
 /* USER CODE END 0 */
 
@@ -54,37 +95,33 @@ void MX_FDCAN1_Init(void)
   hfdcan1.Init.DataSyncJumpWidth = 1;
   hfdcan1.Init.DataTimeSeg1 = 14;
   hfdcan1.Init.DataTimeSeg2 = 2;
-  hfdcan1.Init.StdFiltersNbr = 1;
+  hfdcan1.Init.StdFiltersNbr = 3;
   hfdcan1.Init.ExtFiltersNbr = 0;
-  hfdcan1.Init.TxFifoQueueMode = FDCAN_TX_FIFO_OPERATION;
+  hfdcan1.Init.TxFifoQueueMode = FDCAN_TX_QUEUE_OPERATION;
   if (HAL_FDCAN_Init(&hfdcan1) != HAL_OK)
   {
     Error_Handler();
   }
   /* USER CODE BEGIN FDCAN1_Init 2 */
 
-  // TODO: Config filters
-  FDCAN_FilterTypeDef f1 = {
-      .IdType = FDCAN_STANDARD_ID,
-      .FilterIndex = 0,
-      .FilterType = FDCAN_FILTER_RANGE,
-      .FilterConfig = FDCAN_FILTER_TO_RXFIFO0,
-      .FilterID1 = 0,
-      .FilterID2 = 0x500,
-  };
-  HAL_FDCAN_ConfigFilter(&HCAN_BMS, &f1);
+  _can_config_filters();
   HAL_FDCAN_ActivateNotification(&HCAN_BMS, FDCAN_IT_RX_FIFO0_NEW_MESSAGE, 0U);
 
-  FDCAN_FilterTypeDef f2 = {
-      .IdType = FDCAN_STANDARD_ID,
-      .FilterIndex = 1,
-      .FilterType = FDCAN_FILTER_RANGE,
-      .FilterConfig = FDCAN_FILTER_TO_RXFIFO0,
-      .FilterID1 = 0x550,
-      .FilterID2 = 0x7FF
-  };
-  HAL_FDCAN_ConfigFilter(&HCAN_BMS, &f2);
-  HAL_FDCAN_ActivateNotification(&HCAN_BMS, FDCAN_IT_RX_FIFO0_NEW_MESSAGE, 0U);
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+  // Refill the TX FIFO every time one of its elements is sent
+  HAL_FDCAN_ActivateNotification(
+      &HCAN_BMS,
+      FDCAN_IT_TX_COMPLETE,
+      FDCAN_TX_BUFFER0 | FDCAN_TX_BUFFER1 | FDCAN_TX_BUFFER2
+  );
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+  // Mark the transmission events with the bit time counter to measure the transmission latency
+  HAL_FDCAN_ConfigTimestampCounter(&HCAN_BMS, FDCAN_TIMESTAMP_PRESC_1);
+  HAL_FDCAN_EnableTimestampCounter(&HCAN_BMS, FDCAN_TIMESTAMP_INTERNAL);
+  HAL_FDCAN_ActivateNotification(&HCAN_BMS, FDCAN_IT_TX_EVT_FIFO_NEW_DATA, 0U);
+#endif // CONF_CAN_COMM_STATS_ENABLE
 
   HAL_FDCAN_Start(&HCAN_BMS);
 
@@ -198,6 +235,8 @@ int32_t _can_get_dlc_from_size(const size_t size) {
     }
 };
 
+#define _can_get_size_from_dlc(dlc) (dlc)
+
 /**
  * @brief Get CAN TxFrameType value from the CanFrameType enum
  *
@@ -267,6 +306,13 @@ CanCommReturnCode can_send(
         .MessageMarker = 0U
     };
 
+    /*
+     * The message is sent afterwards if the TX queue is full, the free level
+     * of the FIFO can't be used since it always reads zero in queue mode
+     */
+    if ((HCAN_BMS.Instance->TXFQS & FDCAN_TXFQS_TFQF) != 0U)
+        return CAN_COMM_BUSY;
+
     // Send message
     if (HAL_FDCAN_AddMessageToTxFifoQ(&HCAN_BMS, &header, data) != HAL_OK)
         return CAN_COMM_TRANSMISSION_ERROR;
@@ -279,6 +325,7 @@ void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef * hfdcan, uint32_t RxFifo0ITs
         return;
     if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_NEW_MESSAGE) == RESET)
         return;
+    idle_notify(IDLE_WAKE_REASON_CAN);
 
     FDCAN_RxHeaderTypeDef header;
     uint8_t data[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE];
@@ -289,9 +336,18 @@ void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef * hfdcan, uint32_t RxFifo0ITs
     if (frame_type < 0)
         return;
 
+    /*
+     * The index of the filter that accepted the message is mapped directly to
+     * the message index, the identifier is looked up only when the message was
+     * accepted without matching any filter
+     */
+    const can_index_t index = (header.IsFilterMatchingFrame == 0U) ?
+        can_comm_get_rx_index(header.FilterIndex) :
+        bms_index_from_id(header.Identifier);
+
     // Update rx data
     can_comm_rx_add(
-        bms_index_from_id(header.Identifier),
+        index,
         frame_type,
         data,
         header.DataLength
@@ -304,4 +360,35 @@ void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef * hfdcan, uint32_t RxFifo1ITs
     UNUSED(RxFifo1ITs);
 }
 
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+
+void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef * hfdcan, uint32_t BufferIndexes) {
+    UNUSED(BufferIndexes);
+    if (hfdcan->Instance != HCAN_BMS.Instance)
+        return;
+    can_comm_tx_pump();
+}
+
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+uint16_t can_get_timestamp(void) {
+    return HAL_FDCAN_GetTimestampCounter(&HCAN_BMS);
+}
+
+void HAL_FDCAN_TxEventFifoCallback(FDCAN_HandleTypeDef * hfdcan, uint32_t TxEventFifoITs) {
+    if (hfdcan->Instance != HCAN_BMS.Instance)
+        return;
+    if ((TxEventFifoITs & FDCAN_IT_TX_EVT_FIFO_NEW_DATA) == RESET)
+        return;
+
+    // Read every event so that the FIFO never fills up and loses the following ones
+    FDCAN_TxEventFifoTypeDef event;
+    while (HAL_FDCAN_GetTxEvent(hfdcan, &event) == HAL_OK)
+        can_comm_stats_notify_tx_event((can_id_t)event.Identifier, (uint16_t)event.TxTimestamp);
+}
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
 /* USER CODE END 1 */
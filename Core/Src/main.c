@@ -67,6 +67,11 @@ void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
 
 void system_reset(void);
+void system_sleep(void);
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+uint32_t dwt_get_cycles(void);
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
 
 /* USER CODE END PFP */
 
@@ -224,10 +229,27 @@ int main(void)
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
 
+#ifdef CONF_TIMEBASE_TICKLESS_ENABLE
+  /**
+   * Start the free-running timer used as clock by the timebase, the compare
+   * interrupt is used only to wake up the microcontroller
+   */
+  HAL_TIM_OC_Start_IT(&HTIM_CLOCK, HTIM_CLOCK_CHANNEL);
+#else  // CONF_TIMEBASE_TICKLESS_ENABLE
   /**
    * Start the timer used to increment the timebase internal counter
    */
   HAL_TIM_Base_Start_IT(&HTIM_TIMEBASE);
+#endif // CONF_TIMEBASE_TICKLESS_ENABLE
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+  /**
+   * Enable the CPU cycle counter used to profile the timebase tasks
+   */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
 
   fsm_state_t fsm_state = FSM_STATE_INIT;
 
@@ -236,6 +258,17 @@ int main(void)
       .system_reset = system_reset,
       .cs_enter = it_cs_enter,
       .cs_exit = it_cs_exit,
+      .sleep = system_sleep,
+#ifdef CONF_TIMEBASE_TICKLESS_ENABLE
+      .clock_get = tim_get_clock_counter,
+      .clock_set_alarm = tim_set_clock_alarm,
+#endif // CONF_TIMEBASE_TICKLESS_ENABLE
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+      .profiler_clock_get = dwt_get_cycles,
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+      .can_timestamp_get = can_get_timestamp,
+#endif // CONF_CAN_COMM_STATS_ENABLE
       .can_send = can_send,
       .spi_send = spi_send,
       .spi_send_receive = spi_send_and_receive,
@@ -350,6 +383,30 @@ void system_reset(void) {
     HAL_NVIC_SystemReset();
 }
 
+/**
+ * @brief Put the microcontroller to sleep until an interrupt occurs
+ *
+ * @details The microcontroller wakes up even if the interrupts are disabled
+ * and the pending interrupt is handled as soon as they are enabled again
+ */
+void system_sleep(void) {
+    __DSB();
+    __WFI();
+}
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+
+/**
+ * @brief Get the current value of the CPU cycle counter
+ *
+ * @return uint32_t The number of elapsed CPU cycles
+ */
+uint32_t dwt_get_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+
 #ifdef CONF_FULL_ASSERT_ENABLE
 
 /**
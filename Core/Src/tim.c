@@ -26,6 +26,7 @@
 
 #include "timebase.h"
 #include "error.h"
+#include "idle.h"
 
 /* USER CODE END 0 */
 
@@ -153,6 +154,10 @@ void HAL_TIM_OC_MspInit(TIM_HandleTypeDef* tim_ocHandle)
   /* USER CODE END TIM2_MspInit 0 */
     /* TIM2 clock enable */
     __HAL_RCC_TIM2_CLK_ENABLE();
+
+    /* TIM2 interrupt Init */
+    HAL_NVIC_SetPriority(TIM2_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
   /* USER CODE BEGIN TIM2_MspInit 1 */
 
   /* USER CODE END TIM2_MspInit 1 */
@@ -200,6 +205,9 @@ void HAL_TIM_OC_MspDeInit(TIM_HandleTypeDef* tim_ocHandle)
   /* USER CODE END TIM2_MspDeInit 0 */
     /* Peripheral clock disable */
     __HAL_RCC_TIM2_CLK_DISABLE();
+
+    /* TIM2 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(TIM2_IRQn);
   /* USER CODE BEGIN TIM2_MspDeInit 1 */
 
   /* USER CODE END TIM2_MspDeInit 1 */
@@ -266,6 +274,18 @@ void error_stop_timer_callback(void) {
     HAL_TIM_Base_Stop_IT(&HTIM_ERROR);
 }
 
+uint32_t tim_get_clock_counter(void) {
+    return __HAL_TIM_GET_COUNTER(&HTIM_CLOCK);
+}
+
+void tim_set_clock_alarm(const uint32_t counter) {
+    __HAL_TIM_SET_COMPARE(&HTIM_CLOCK, HTIM_CLOCK_CHANNEL, counter);
+
+    // Trigger the alarm immediately if the counter has already passed the given value
+    if ((int32_t)(__HAL_TIM_GET_COUNTER(&HTIM_CLOCK) - counter) >= 0)
+        HAL_TIM_GenerateEvent(&HTIM_CLOCK, TIM_EVENTSOURCE_CC1);
+}
+
 /**
  * @brief Timer period elapsed callback
  *
@@ -277,6 +297,7 @@ void error_stop_timer_callback(void) {
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef * htim) {
     if (htim->Instance == HTIM_TIMEBASE.Instance) {
         timebase_inc_tick();
+        idle_notify(IDLE_WAKE_REASON_TIMEBASE);
     }
     else if (htim->Instance == HTIM_ERROR.Instance) {
         // Stop the timer and expire the error
@@ -285,4 +306,17 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef * htim) {
     }
 }
 
+/**
+ * @brief Timer output compare callback
+ *
+ * @details This function is called when a timer counter reaches the compare value
+ *
+ * @param htim A pointer to the timer handler structure
+ */
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef * htim) {
+    // The timebase alarm is only used to wake up the microcontroller
+    if (htim->Instance == HTIM_CLOCK.Instance)
+        idle_notify(IDLE_WAKE_REASON_TIMEBASE);
+}
+
 /* USER CODE END 1 */
@@ -0,0 +1,566 @@
+/**
+ * @file sim_firmware.c
+ * @date 2024-10-16
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ *
+ * @brief Deterministic host simulation of the whole cellboard firmware
+ *
+ * @details The firmware is started from the init state of the main FSM exactly
+ * as the main function does on the target and all the peripherals are replaced
+ * with simulated callbacks that runs on a virtual clock:
+ *     - the timebase tick (or the alarm in tickless mode)
+ *     - the SPI with a chain of LTC6811 that answers to the commands sent by the BMS manager
+ *     - the ADC and the multiplexer used to read the cells temperatures
+ *     - the CAN transmission
+ *
+ * @details Each main loop iteration and each SPI transfer consume a fixed amount
+ * of virtual time so the result of the simulation only depends on the firmware
+ *
+ * @details The simulation reports the number of main loop iterations for each
+ * tick, the number of CAN frames sent and the latency between the reading of
+ * the cells voltages from the LTCs and their transmission via CAN
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fsm.h"
+#include "post.h"
+#include "idle.h"
+#include "can-comm.h"
+#include "timebase.h"
+#include "volt.h"
+#include "temp.h"
+#include "cellboard-def.h"
+#include "cellboard-conf.h"
+
+/** @brief Number of simulated seconds */
+#define SIM_FIRMWARE_SECONDS (60U)
+
+/** @brief Time needed by a single iteration of the main loop in us */
+#define SIM_FIRMWARE_LOOP_US (5U)
+
+/** @brief Time needed to transfer a single byte via SPI in us (1 MHz clock) */
+#define SIM_FIRMWARE_SPI_BYTE_US (8U)
+
+/** @brief Time needed by the ADC to complete a conversion in us */
+#define SIM_FIRMWARE_ADC_US (50U)
+
+/** @brief Time needed by the LTCs to convert all the cells voltages in us */
+#define SIM_FIRMWARE_LTC_CONVERSION_US (2400U)
+
+/** @brief Time needed by the LTCs to convert all the GPIOs in us */
+#define SIM_FIRMWARE_LTC_AUX_CONVERSION_US (2000U)
+
+/** @brief Period of the timebase tick in us */
+#define SIM_FIRMWARE_TICK_US (TIMEBASE_RESOLUTION_MS * 1000U)
+
+/** @brief Time that represents an event that never happens */
+#define SIM_FIRMWARE_NEVER (UINT64_MAX)
+
+/** @brief Width of a bin of the latency histogram in us */
+#define SIM_FIRMWARE_LATENCY_BIN_US (10000U)
+
+/** @brief Number of bins of the latency histogram, the last one counts all the greater latencies */
+#define SIM_FIRMWARE_LATENCY_BIN_COUNT (101U)
+
+/** @brief Maximum number of loop iterations per tick that are counted separately */
+#define SIM_FIRMWARE_LOOPS_PER_TICK_MAX (64U)
+
+/**
+ * @brief LTC6811 command codes as defined in the datasheet
+ *
+ * @details The conversion commands contains the mode and channels bits that
+ * are masked before the comparison
+ */
+#define SIM_LTC_WRCFG (0x001U)
+#define SIM_LTC_RDCFG (0x002U)
+#define SIM_LTC_RDCVA (0x004U)
+#define SIM_LTC_RDCVB (0x006U)
+#define SIM_LTC_RDCVC (0x008U)
+#define SIM_LTC_RDCVD (0x00AU)
+#define SIM_LTC_RDAUXA (0x00CU)
+#define SIM_LTC_RDAUXB (0x00EU)
+#define SIM_LTC_PLADC (0x714U)
+#define SIM_LTC_ADCV (0x260U)
+#define SIM_LTC_ADCV_MASK (0x197U)
+#define SIM_LTC_ADOW (0x228U)
+#define SIM_LTC_ADOW_MASK (0x1D7U)
+#define SIM_LTC_ADAX (0x460U)
+#define SIM_LTC_ADAX_MASK (0x187U)
+
+/** @brief Size of a single register and of its PEC in bytes */
+#define SIM_LTC_REG_BYTE_SIZE (6U)
+#define SIM_LTC_PEC_BYTE_SIZE (2U)
+
+/** @brief Number of GPIO values that can be read from the auxiliary registers */
+#define SIM_LTC_AUX_COUNT (6U)
+
+/**
+ * @brief Type of the last conversion started on the LTCs
+ *
+ * @details The same register is read after a normal or an open wire conversion
+ * but only the former updates the cells voltages
+ */
+typedef enum {
+    SIM_LTC_CONVERSION_NONE,
+    SIM_LTC_CONVERSION_CELLS,
+    SIM_LTC_CONVERSION_OPEN_WIRE,
+    SIM_LTC_CONVERSION_AUX
+} SimLtcConversion;
+
+/**
+ * @brief Simulated chain of LTC6811
+ *
+ * @details The data of each LTC is stored in the same order in which it is
+ * sent through the chain
+ *
+ * @param config The configuration register of each LTC
+ * @param conversion The type of the last conversion started
+ * @param conversion_end_us The time when the last conversion ends
+ * @param pec_errors The number of commands received with a wrong PEC
+ */
+typedef struct {
+    uint8_t config[CELLBOARD_SEGMENT_LTC_COUNT][SIM_LTC_REG_BYTE_SIZE];
+    SimLtcConversion conversion;
+    uint64_t conversion_end_us;
+    uint32_t pec_errors;
+} SimLtcChain;
+
+static uint64_t now_us = 0U;
+static uint64_t tick_us = SIM_FIRMWARE_NEVER;
+static uint64_t alarm_us = SIM_FIRMWARE_NEVER;
+static uint64_t adc_us = SIM_FIRMWARE_NEVER;
+
+static SimLtcChain ltc;
+static uint16_t pec15_table[256U];
+
+static uint32_t spi_transfers = 0U;
+static uint32_t system_resets = 0U;
+static uint8_t mux_address = 0U;
+
+static uint32_t frames_sent = 0U;
+static uint32_t frames_sent_by_id[2048U];
+
+/** @brief Time of the last read of each cell and true if it was not sent yet */
+static uint64_t volt_read_us[CELLBOARD_SEGMENT_SERIES_COUNT];
+static bool volt_pending[CELLBOARD_SEGMENT_SERIES_COUNT];
+static uint32_t volt_overwritten = 0U;
+
+static uint32_t latency_hist[SIM_FIRMWARE_LATENCY_BIN_COUNT];
+static uint64_t latency_sum_us = 0U;
+static uint64_t latency_max_us = 0U;
+static uint64_t latency_min_us = SIM_FIRMWARE_NEVER;
+static uint32_t latency_count = 0U;
+
+static uint32_t loops_per_tick_hist[SIM_FIRMWARE_LOOPS_PER_TICK_MAX + 1U];
+
+/** @brief Initialize the table used to calculate the PEC of the LTC6811 (CRC15) */
+static void pec15_init(void) {
+    for (uint16_t i = 0U; i < 256U; ++i) {
+        uint16_t rem = i << 7U;
+        for (size_t bit = 0U; bit < 8U; ++bit) {
+            if (rem & 0x4000U)
+                rem = (uint16_t)((rem << 1U) ^ 0x4599U);
+            else
+                rem = (uint16_t)(rem << 1U);
+        }
+        pec15_table[i] = rem & 0x7FFFU;
+    }
+}
+
+static uint16_t pec15(const uint8_t * const data, const size_t size) {
+    uint16_t rem = 16U;
+    for (size_t i = 0U; i < size; ++i) {
+        const uint8_t addr = ((rem >> 7U) ^ data[i]) & 0xFFU;
+        rem = (uint16_t)((rem << 8U) ^ pec15_table[addr]) & 0x7FFFU;
+    }
+    return (uint16_t)(rem << 1U);
+}
+
+static void pec15_append(uint8_t * const data, const size_t size) {
+    const uint16_t pec = pec15(data, size);
+    data[size] = (uint8_t)(pec >> 8U);
+    data[size + 1U] = (uint8_t)(pec & 0xFFU);
+}
+
+static bool pec15_check(const uint8_t * const data, const size_t size) {
+    const uint16_t pec = pec15(data, size);
+    return data[size] == (uint8_t)(pec >> 8U) && data[size + 1U] == (uint8_t)(pec & 0xFFU);
+}
+
+/**
+ * @brief Get the raw voltage of a cell in 100 uV
+ *
+ * @details The cells discharge slowly and each one has a slightly different voltage
+ */
+static uint16_t sim_cell_raw_voltage(const size_t index) {
+    const uint64_t discharge = now_us / 100000U;
+    return (uint16_t)(37000U + 10U * index - CELLBOARD_MIN(discharge, 5000U));
+}
+
+/**
+ * @brief Get the index of the cell used by the firmware from the position in the chain
+ *
+ * @details The first cell is connected to the last LTC of the chain
+ */
+static size_t sim_cell_index(const size_t ltc_index, const size_t reg, const size_t i) {
+    const size_t ltc_pos = CELLBOARD_SEGMENT_LTC_COUNT - ltc_index - 1U;
+    return reg * LTC6811_REG_CELL_COUNT + ltc_pos * LTC6811_CELL_COUNT + i;
+}
+
+static uint64_t next_event(void) {
+    uint64_t t = CELLBOARD_MIN(tick_us, adc_us);
+    return CELLBOARD_MIN(t, alarm_us);
+}
+
+/** @brief Advance the virtual time executing the interrupts that occur in between */
+static void advance(const uint64_t t) {
+    for (uint64_t ev = next_event(); ev <= t; ev = next_event()) {
+        now_us = CELLBOARD_MAX(now_us, ev);
+        if (ev == tick_us) {
+            timebase_inc_tick();
+            idle_notify(IDLE_WAKE_REASON_TIMEBASE);
+            tick_us += SIM_FIRMWARE_TICK_US;
+        }
+        if (ev == alarm_us) {
+            idle_notify(IDLE_WAKE_REASON_TIMEBASE);
+            alarm_us = SIM_FIRMWARE_NEVER;
+        }
+        if (ev == adc_us) {
+            // Same voltage for all the channels, about 19 °C
+            const volt_t values[CELLBOARD_SEGMENT_TEMP_CHANNEL_COUNT] = { [0 ... CELLBOARD_SEGMENT_TEMP_CHANNEL_COUNT - 1U] = 1.5f };
+            (void)temp_notify_conversion_complete(values, CELLBOARD_SEGMENT_TEMP_CHANNEL_COUNT);
+            idle_notify(IDLE_WAKE_REASON_ADC);
+            adc_us = SIM_FIRMWARE_NEVER;
+        }
+    }
+    now_us = CELLBOARD_MAX(now_us, t);
+}
+
+static void system_reset(void) {
+    ++system_resets;
+}
+
+static void cs_enter(void) { }
+
+static void cs_exit(void) { }
+
+static void sleep(void) {
+    advance(CELLBOARD_MAX(next_event(), now_us));
+}
+
+#ifdef CONF_TIMEBASE_TICKLESS_ENABLE
+
+static uint32_t clock_get(void) {
+    return (uint32_t)now_us;
+}
+
+static void clock_set_alarm(const uint32_t counter) {
+    alarm_us = now_us + (uint32_t)(counter - (uint32_t)now_us);
+}
+
+#endif // CONF_TIMEBASE_TICKLESS_ENABLE
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+
+static uint32_t profiler_clock_get(void) {
+    return (uint32_t)(now_us * (TIMEBASE_PROFILER_CLOCK_FREQUENCY_HZ / 1000000U));
+}
+
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+
+/** @brief Record the latency between the reading of the cells and their transmission */
+static void sim_record_voltages(const uint8_t * const data, const size_t size) {
+    bms_cellboard_cells_voltage_t raw;
+    bms_cellboard_cells_voltage_converted_t conv;
+    bms_cellboard_cells_voltage_unpack(&raw, data, size);
+    bms_cellboard_cells_voltage_raw_to_conversion_struct(&conv, &raw);
+
+    for (size_t i = 0U; i < LTC6811_REG_CELL_COUNT; ++i) {
+        const size_t index = conv.offset + i;
+        if (index >= CELLBOARD_SEGMENT_SERIES_COUNT || !volt_pending[index])
+            continue;
+        volt_pending[index] = false;
+
+        const uint64_t latency = now_us - volt_read_us[index];
+        const size_t bin = CELLBOARD_MIN(latency / SIM_FIRMWARE_LATENCY_BIN_US, SIM_FIRMWARE_LATENCY_BIN_COUNT - 1U);
+        ++latency_hist[bin];
+        latency_sum_us += latency;
+        latency_max_us = CELLBOARD_MAX(latency_max_us, latency);
+        latency_min_us = CELLBOARD_MIN(latency_min_us, latency);
+        ++latency_count;
+    }
+}
+
+static CanCommReturnCode can_send(
+    const can_id_t id,
+    const CanFrameType frame_type,
+    const uint8_t * const data,
+    const size_t size)
+{
+    ++frames_sent;
+    ++frames_sent_by_id[id & 0x7FFU];
+    if (id == BMS_CELLBOARD_CELLS_VOLTAGE_FRAME_ID && frame_type == CAN_FRAME_TYPE_DATA)
+        sim_record_voltages(data, size);
+    return CAN_COMM_OK;
+}
+
+/** @brief Execute a command received by the LTCs */
+static void sim_ltc_command(const uint8_t * const cmd, const size_t size) {
+    const uint16_t code = (uint16_t)((cmd[0U] << 8U) | cmd[1U]) & 0x7FFU;
+    if ((code & ~SIM_LTC_ADCV_MASK) == SIM_LTC_ADCV) {
+        ltc.conversion = SIM_LTC_CONVERSION_CELLS;
+        ltc.conversion_end_us = now_us + SIM_FIRMWARE_LTC_CONVERSION_US;
+    }
+    else if ((code & ~SIM_LTC_ADOW_MASK) == SIM_LTC_ADOW) {
+        ltc.conversion = SIM_LTC_CONVERSION_OPEN_WIRE;
+        ltc.conversion_end_us = now_us + SIM_FIRMWARE_LTC_CONVERSION_US;
+    }
+    else if ((code & ~SIM_LTC_ADAX_MASK) == SIM_LTC_ADAX) {
+        ltc.conversion = SIM_LTC_CONVERSION_AUX;
+        ltc.conversion_end_us = now_us + SIM_FIRMWARE_LTC_AUX_CONVERSION_US;
+    }
+    else if (code == SIM_LTC_WRCFG) {
+        const size_t reg_size = SIM_LTC_REG_BYTE_SIZE + SIM_LTC_PEC_BYTE_SIZE;
+        for (size_t i = 0U; i < CELLBOARD_SEGMENT_LTC_COUNT; ++i) {
+            const uint8_t * const reg = cmd + 4U + i * reg_size;
+            if (4U + (i + 1U) * reg_size > size || !pec15_check(reg, SIM_LTC_REG_BYTE_SIZE)) {
+                ++ltc.pec_errors;
+                return;
+            }
+            memcpy(ltc.config[i], reg, SIM_LTC_REG_BYTE_SIZE);
+        }
+    }
+}
+
+/** @brief Fill the data read from a register of the LTCs */
+static void sim_ltc_read(const uint16_t code, uint8_t * const out, const size_t out_size) {
+    for (size_t i = 0U; i < CELLBOARD_SEGMENT_LTC_COUNT; ++i) {
+        uint8_t * const reg = out + i * (SIM_LTC_REG_BYTE_SIZE + SIM_LTC_PEC_BYTE_SIZE);
+        if (reg + SIM_LTC_REG_BYTE_SIZE + SIM_LTC_PEC_BYTE_SIZE > out + out_size)
+            return;
+
+        uint16_t values[LTC6811_REG_CELL_COUNT] = { 0U };
+        switch (code) {
+            case SIM_LTC_RDCFG:
+                memcpy(reg, ltc.config[i], SIM_LTC_REG_BYTE_SIZE);
+                break;
+            case SIM_LTC_RDCVA:
+            case SIM_LTC_RDCVB:
+            case SIM_LTC_RDCVC:
+            case SIM_LTC_RDCVD:
+            {
+                const size_t r = (code - SIM_LTC_RDCVA) / 2U;
+                for (size_t j = 0U; j < LTC6811_REG_CELL_COUNT; ++j) {
+                    const size_t index = sim_cell_index(i, r, j);
+                    values[j] = sim_cell_raw_voltage(index);
+
+                    // Only the normal conversion updates the cells voltages
+                    if (ltc.conversion == SIM_LTC_CONVERSION_CELLS) {
+                        volt_overwritten += volt_pending[index] ? 1U : 0U;
+                        volt_pending[index] = true;
+                        volt_read_us[index] = now_us;
+                    }
+                }
+                break;
+            }
+            case SIM_LTC_RDAUXA:
+            case SIM_LTC_RDAUXB:
+            {
+                const size_t r = (code - SIM_LTC_RDAUXA) / 2U;
+                for (size_t j = 0U; j < LTC6811_REG_AUX_COUNT; ++j)
+                    // GPIOs at 2 V and the reference at 3 V
+                    values[j] = (r * LTC6811_REG_AUX_COUNT + j == SIM_LTC_AUX_COUNT - 1U) ? 30000U : 20000U;
+                break;
+            }
+            default:
+                memset(reg, 0xFFU, SIM_LTC_REG_BYTE_SIZE);
+                break;
+        }
+        if (code >= SIM_LTC_RDCVA && code <= SIM_LTC_RDAUXB) {
+            // Values are sent in little endian order
+            for (size_t j = 0U; j < LTC6811_REG_CELL_COUNT; ++j) {
+                reg[2U * j] = (uint8_t)(values[j] & 0xFFU);
+                reg[2U * j + 1U] = (uint8_t)(values[j] >> 8U);
+            }
+        }
+        pec15_append(reg, SIM_LTC_REG_BYTE_SIZE);
+    }
+}
+
+static BmsManagerReturnCode spi_send(uint8_t * const data, const size_t size) {
+    ++spi_transfers;
+    if (size < 4U || !pec15_check(data, 2U)) {
+        ++ltc.pec_errors;
+        return BMS_MANAGER_OK;
+    }
+    sim_ltc_command(data, size);
+    advance(now_us + size * SIM_FIRMWARE_SPI_BYTE_US);
+    return BMS_MANAGER_OK;
+}
+
+static BmsManagerReturnCode spi_send_receive(
+    uint8_t * const data,
+    uint8_t * out,
+    const size_t size,
+    const size_t out_size)
+{
+    ++spi_transfers;
+    memset(out, 0xFFU, out_size);
+    if (size < 4U || !pec15_check(data, 2U)) {
+        ++ltc.pec_errors;
+        return BMS_MANAGER_OK;
+    }
+
+    const uint16_t code = (uint16_t)((data[0U] << 8U) | data[1U]) & 0x7FFU;
+    if (code == SIM_LTC_PLADC)
+        // The SDO line is kept low until the conversion ends
+        memset(out, now_us < ltc.conversion_end_us ? 0U : 0xFFU, out_size);
+    else
+        sim_ltc_read(code, out, out_size);
+
+    advance(now_us + (size + out_size) * SIM_FIRMWARE_SPI_BYTE_US);
+    return BMS_MANAGER_OK;
+}
+
+static void led_set(const LedStatus state) {
+    CELLBOARD_UNUSED(state);
+}
+
+static void led_toggle(void) { }
+
+static void gpio_set_address(const uint8_t address) {
+    mux_address = address;
+}
+
+static void adc_start(void) {
+    adc_us = now_us + SIM_FIRMWARE_ADC_US;
+}
+
+/** @brief Get a percentile of the latency from the histogram in ms */
+static double sim_latency_percentile(const double p) {
+    const uint32_t target = (uint32_t)(p * latency_count);
+    uint32_t count = 0U;
+    for (size_t i = 0U; i < SIM_FIRMWARE_LATENCY_BIN_COUNT; ++i) {
+        count += latency_hist[i];
+        if (count > target)
+            return (double)((i + 1U) * SIM_FIRMWARE_LATENCY_BIN_US) / 1000.0;
+    }
+    return (double)(SIM_FIRMWARE_LATENCY_BIN_COUNT * SIM_FIRMWARE_LATENCY_BIN_US) / 1000.0;
+}
+
+static void sim_report(const uint32_t loops, const fsm_state_t state) {
+    const double seconds = (double)now_us / 1000000.0;
+    const uint32_t ticks = (uint32_t)(now_us / SIM_FIRMWARE_TICK_US);
+
+    printf("simulated time: %.1f s, main loop iteration: %u us, tickless: %s\n",
+        seconds,
+        SIM_FIRMWARE_LOOP_US,
+#ifdef CONF_TIMEBASE_TICKLESS_ENABLE
+        "yes"
+#else  // CONF_TIMEBASE_TICKLESS_ENABLE
+        "no"
+#endif // CONF_TIMEBASE_TICKLESS_ENABLE
+    );
+    printf("final state: %s, system resets: %u, spi transfers: %u, pec errors: %u\n",
+        fsm_state_names[state],
+        system_resets,
+        spi_transfers,
+        ltc.pec_errors
+    );
+
+    // Main loop
+    printf("\nmain loop: %u iterations, %.2f per tick, %u sleeps\n",
+        loops,
+        (double)loops / ticks,
+        idle_get_sleep_count()
+    );
+    printf("iterations per tick:");
+    for (size_t i = 0U; i <= SIM_FIRMWARE_LOOPS_PER_TICK_MAX; ++i) {
+        if (loops_per_tick_hist[i] > 0U)
+            printf(" %s%zu: %u", i == SIM_FIRMWARE_LOOPS_PER_TICK_MAX ? ">=" : "", i, loops_per_tick_hist[i]);
+    }
+    printf("\n");
+
+    // CAN bus
+    printf("\ncan: %u frames, %.1f frames/s\n", frames_sent, frames_sent / seconds);
+    for (size_t id = 0U; id < sizeof(frames_sent_by_id) / sizeof(frames_sent_by_id[0U]); ++id) {
+        if (frames_sent_by_id[id] > 0U)
+            printf("    0x%03zx: %8u frames, %7.1f frames/s\n", id, frames_sent_by_id[id], frames_sent_by_id[id] / seconds);
+    }
+    printf("    cells voltages: %u payloads sent, %u saved\n", volt_get_sent_frame_count(), volt_get_saved_frame_count());
+    printf("    cells temperatures: %u payloads sent, %u saved\n", temp_get_sent_frame_count(), temp_get_saved_frame_count());
+    printf("    serialization cache: %u hits, %u misses\n", can_comm_get_tx_cache_hit_count(), can_comm_get_tx_cache_miss_count());
+
+    // Latency
+    printf("\nltc read -> can frame latency: %u samples, %u reads overwritten before being sent\n",
+        latency_count,
+        volt_overwritten
+    );
+    if (latency_count > 0U) {
+        printf("    min %.3f ms, mean %.3f ms, max %.3f ms, p50 <= %.0f ms, p99 <= %.0f ms\n",
+            (double)latency_min_us / 1000.0,
+            (double)latency_sum_us / latency_count / 1000.0,
+            (double)latency_max_us / 1000.0,
+            sim_latency_percentile(0.5),
+            sim_latency_percentile(0.99)
+        );
+    }
+}
+
+int main() {
+    pec15_init();
+    memset(&ltc, 0U, sizeof(ltc));
+
+#ifdef CONF_TIMEBASE_TICKLESS_ENABLE
+    tick_us = SIM_FIRMWARE_NEVER;
+#else  // CONF_TIMEBASE_TICKLESS_ENABLE
+    tick_us = SIM_FIRMWARE_TICK_US;
+#endif // CONF_TIMEBASE_TICKLESS_ENABLE
+
+    PostInitData init_data = {
+        .id = CELLBOARD_ID_0,
+        .system_reset = system_reset,
+        .cs_enter = cs_enter,
+        .cs_exit = cs_exit,
+        .sleep = sleep,
+#ifdef CONF_TIMEBASE_TICKLESS_ENABLE
+        .clock_get = clock_get,
+        .clock_set_alarm = clock_set_alarm,
+#endif // CONF_TIMEBASE_TICKLESS_ENABLE
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+        .profiler_clock_get = profiler_clock_get,
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+        .can_send = can_send,
+        .spi_send = spi_send,
+        .spi_send_receive = spi_send_receive,
+        .led_set = led_set,
+        .led_toggle = led_toggle,
+        .gpio_set_address = gpio_set_address,
+        .adc_start = adc_start
+    };
+    fsm_state_t state = fsm_run_state(FSM_STATE_INIT, &init_data);
+
+    // Run the main loop
+    const uint64_t end_us = (uint64_t)SIM_FIRMWARE_SECONDS * 1000000U;
+    uint64_t tick_start_us = now_us;
+    uint32_t loops = 0U;
+    uint32_t tick_loops = 0U;
+    while (now_us < end_us) {
+        state = fsm_run_state(state, NULL);
+        advance(now_us + SIM_FIRMWARE_LOOP_US);
+        ++loops;
+        ++tick_loops;
+
+        // Count the iterations done in each tick period
+        while (now_us - tick_start_us >= SIM_FIRMWARE_TICK_US) {
+            ++loops_per_tick_hist[CELLBOARD_MIN(tick_loops, SIM_FIRMWARE_LOOPS_PER_TICK_MAX)];
+            tick_loops = 0U;
+            tick_start_us += SIM_FIRMWARE_TICK_US;
+        }
+    }
+
+    sim_report(loops, state);
+    return 0;
+}
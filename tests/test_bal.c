@@ -11,6 +11,7 @@
 #include "identity.h"
 #include "cellboard-def.h"
 #include "bms-manager.h"
+#include "can-comm.h"
 
 #define CELLBOARD_ID CELLBOARD_ID_1
 
@@ -188,6 +189,32 @@ void test_bal_set_balancing_status_handle_event() {
     TEST_ASSERT_EQUAL(FSM_EVENT_TYPE_BALANCING_START, hbal.event.type);
 }
 
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
+void test_bal_raw_payload_bit_identical() {
+    // The raw payload is left unchanged by a conversion round trip, so it is sent as the converted one
+    const bit_flag16_t patterns[] = { 0x000U, 0xFFFU, 0x555U, 0xAAAU, 0x801U };
+    const size_t count = sizeof(patterns) / sizeof(patterns[0U]);
+    for (size_t p = 0U; p < count; ++p) {
+        for (size_t ltc = 0U; ltc < CELLBOARD_SEGMENT_LTC_COUNT; ++ltc)
+            hmanager.actual_config[ltc].DCC = patterns[(p + ltc) % count];
+        const bal_status_canlib_payload_t * const payload = bal_get_status_canlib_payload(NULL);
+
+        bms_cellboard_balancing_status_converted_t conv;
+        bms_cellboard_balancing_status_t raw;
+        bms_cellboard_balancing_status_raw_to_conversion_struct(&conv, payload);
+        bms_cellboard_balancing_status_conversion_to_raw_struct(&raw, &conv);
+
+        uint8_t expected[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE] = { 0U };
+        uint8_t actual[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE] = { 0U };
+        bms_cellboard_balancing_status_pack(expected, &raw, sizeof(expected));
+        bms_cellboard_balancing_status_pack(actual, payload, sizeof(actual));
+        TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected));
+    }
+}
+
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 int main() {
     UNITY_BEGIN();
     RUN_TEST(test_bal_init_ok);
@@ -215,6 +242,9 @@ int main() {
     RUN_TEST(test_bal_set_balancing_status_handle_target);
     RUN_TEST(test_bal_set_balancing_status_handle_threshold);
     RUN_TEST(test_bal_set_balancing_status_handle_event);
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    RUN_TEST(test_bal_raw_payload_bit_identical);
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
     return UNITY_END();
 }
 
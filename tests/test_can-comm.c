@@ -7,6 +7,10 @@
  */
 
 
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
 #include "unity.h"
 #include "can-comm.h"
 #include "identity.h"
@@ -14,29 +18,124 @@
 
 #define CELLBOARD_ID CELLBOARD_ID_1
 
+/** @brief Number of messages exchanged by the producer and consumer threads in the stress tests */
+#define STRESS_MESSAGE_COUNT (100000U)
+
 extern _CanCommHandler hcan_comm;
+extern const can_id_t can_comm_id[CAN_COMM_MESSAGE_COUNT];
+extern const can_comm_canlib_serialize_callback_t can_comm_serialize[CAN_COMM_MESSAGE_COUNT];
+extern const can_comm_canlib_deserialize_callback_t can_comm_deserialize[CAN_COMM_MESSAGE_COUNT];
+extern const uint8_t can_comm_tx_position[CAN_COMM_MESSAGE_COUNT];
+CanMessage * _can_comm_rx_peek(void);
+void _can_comm_rx_release(void);
 
 
+/**
+ * @brief Number of free elements of the hardware transmission FIFO after setup
+ *
+ * @details When the messages are sent from the interrupt the hardware is full
+ * by default so that the added messages wait inside the queue
+ */
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+#define HW_FREE_DEFAULT (0U)
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+#define HW_FREE_DEFAULT (SIZE_MAX)
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
 bool sended;
+size_t sent_count;
+can_id_t sent_ids[CAN_COMM_MESSAGE_COUNT];
+can_id_t last_sent_id;
+uint8_t sent_data[CAN_COMM_MESSAGE_COUNT][CAN_COMM_TX_FRAME_BYTE_SIZE];
+size_t sent_sizes[CAN_COMM_MESSAGE_COUNT];
+size_t hw_free;
+CanCommReturnCode hw_ret;
+size_t cs_depth;
+size_t sent_cs_depth;
+uint16_t timestamp;
 CanCommReturnCode can_comm_send(can_id_t id, CanFrameType frame_type, const uint8_t *data, size_t size) {
+    if (hw_free == 0U)
+        return CAN_COMM_BUSY;
+    if (hw_ret != CAN_COMM_OK)
+        return hw_ret;
+    --hw_free;
     sended = true;
+    sent_cs_depth = cs_depth;
+    last_sent_id = id;
+    if (sent_count < CAN_COMM_MESSAGE_COUNT) {
+        sent_ids[sent_count] = id;
+        memcpy(sent_data[sent_count], data, CELLBOARD_MIN(size, CAN_COMM_TX_FRAME_BYTE_SIZE));
+        sent_sizes[sent_count] = size;
+    }
+    ++sent_count;
     return CAN_COMM_OK;
 }
 
+void cs_enter(void) {
+    ++cs_depth;
+}
+
+void cs_exit(void) {
+    --cs_depth;
+}
+
+uint16_t timestamp_get(void) {
+    return timestamp;
+}
+
+/** @brief Try to send the messages as the main loop or the transmission interrupt would do */
+void tx_attempt(void) {
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    can_comm_tx_pump();
+#else  // CONF_CAN_COMM_TX_ISR_ENABLE
+    can_comm_routine();
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+}
+
+/** @brief Send all the messages waiting inside the queue */
+void tx_flush(void) {
+    hw_free = SIZE_MAX;
+    while (can_comm_tx_get_pending_count() > 0U)
+        tx_attempt();
+}
+
+/**
+ * @brief Get the lowest identifier of the messages waiting to be sent
+ *
+ * @return can_id_t The identifier or CAN_COMM_ID_MASK + 1 if no message is waiting
+ */
+can_id_t tx_lowest_pending_id(void) {
+    can_id_t id = CAN_COMM_ID_MASK + 1U;
+    for (can_index_t index = 0; index < CAN_COMM_MESSAGE_COUNT; ++index) {
+        if (can_comm_tx_is_pending(index))
+            id = CELLBOARD_MIN(id, can_comm_id[index]);
+    }
+    return id;
+}
+
 void setUp() {
     identity_init(CELLBOARD_ID);
-    can_comm_init(can_comm_send);
+    can_comm_init(can_comm_send, cs_enter, cs_exit);
+    can_comm_stats_init(timestamp_get);
     sended = false;
+    sent_count = 0U;
+    hw_free = HW_FREE_DEFAULT;
+    hw_ret = CAN_COMM_OK;
+    timestamp = 0U;
+    cs_depth = 0U;
+    sent_cs_depth = 0U;
 }
 
 void tearDown() {}
 
 void test_can_comm_init_null() {
-    TEST_ASSERT_EQUAL(CAN_COMM_NULL_POINTER, can_comm_init(NULL));
+    TEST_ASSERT_EQUAL(CAN_COMM_NULL_POINTER, can_comm_init(NULL, cs_enter, cs_exit));
+    TEST_ASSERT_EQUAL(CAN_COMM_NULL_POINTER, can_comm_init(can_comm_send, NULL, cs_exit));
+    TEST_ASSERT_EQUAL(CAN_COMM_NULL_POINTER, can_comm_init(can_comm_send, cs_enter, NULL));
 }
 
 void test_can_comm_init_ok() {
-    TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_init(can_comm_send));
+    TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_init(can_comm_send, cs_enter, cs_exit));
 }
 
 void test_can_comm_enable_all() {
@@ -78,12 +177,14 @@ void test_can_comm_is_enabled_true() {
 }
 
 void test_can_comm_send_immediate_ok() {
+    hw_free = SIZE_MAX;
     can_comm_enable_all();
     CanCommReturnCode ret = can_comm_send_immediate(0, CAN_FRAME_TYPE_DATA, (void*)0x01, 0);
     TEST_ASSERT_EQUAL(CAN_COMM_OK, ret);
 }
 
 void test_can_comm_send_immediate_sended() {
+    hw_free = SIZE_MAX;
     can_comm_enable_all();
     can_comm_send_immediate(0, CAN_FRAME_TYPE_DATA, (void*)0x01, 0);
     TEST_ASSERT_TRUE(sended);
@@ -102,7 +203,7 @@ void test_can_comm_send_immediate_invalid_frame_type() {
 
 void test_can_comm_send_immediate_invalid_payload_size() {
     can_comm_enable_all();
-    CanCommReturnCode ret = can_comm_send_immediate(0, CAN_FRAME_TYPE_DATA, (void*)0x01, CELLBOARD_CAN_MAX_PAYLOAD_BYTE_SIZE+1);
+    CanCommReturnCode ret = can_comm_send_immediate(0, CAN_FRAME_TYPE_DATA, (void*)0x01, CAN_COMM_TX_MAILBOX_BYTE_SIZE+1);
     TEST_ASSERT_EQUAL(CAN_COMM_INVALID_PAYLOAD_SIZE, ret);
 }
 
@@ -119,7 +220,7 @@ void test_can_comm_rx_add_disabled() {
 
 void test_can_comm_rx_add_invalid_index() {
     can_comm_enable_all();
-    CanCommReturnCode ret = can_comm_rx_add(bms_MESSAGE_COUNT, CAN_FRAME_TYPE_DATA, NULL, 0);
+    CanCommReturnCode ret = can_comm_rx_add(CAN_COMM_MESSAGE_COUNT, CAN_FRAME_TYPE_DATA, NULL, 0);
     TEST_ASSERT_EQUAL(CAN_COMM_INVALID_INDEX, ret);
 }
 
@@ -131,7 +232,7 @@ void test_can_comm_rx_add_null() {
 
 void test_can_comm_rx_add_invalid_payload_size() {
     can_comm_enable_all();
-    CanCommReturnCode ret = can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, (void*)0x01, CELLBOARD_CAN_MAX_PAYLOAD_BYTE_SIZE+1);
+    CanCommReturnCode ret = can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, (void*)0x01, CAN_COMM_MAX_PAYLOAD_BYTE_SIZE+1);
     TEST_ASSERT_EQUAL(CAN_COMM_INVALID_PAYLOAD_SIZE, ret);
 }
 
@@ -141,6 +242,13 @@ void test_can_comm_rx_add_invalid_frame() {
     TEST_ASSERT_EQUAL(CAN_COMM_INVALID_FRAME_TYPE, ret);
 }
 
+void test_can_comm_rx_add_remote() {
+    can_comm_enable_all();
+    CanCommReturnCode ret = can_comm_rx_add(0, CAN_FRAME_TYPE_REMOTE, NULL, 0);
+    TEST_ASSERT_EQUAL(CAN_COMM_INVALID_FRAME_TYPE, ret);
+    TEST_ASSERT_NULL(_can_comm_rx_peek());
+}
+
 void test_can_comm_rx_add_ok() {
     can_comm_enable_all();
     CanCommReturnCode ret = can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, (void*)0x01, 0);
@@ -152,8 +260,7 @@ void test_can_comm_rx_add_added() {
     can_comm_enable_all();
     CanCommReturnCode ret = can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, (void*)(0x01), 0);
 
-    CanMessage rx_msg;
-    TEST_ASSERT_EQUAL(RING_BUFFER_OK, ring_buffer_pop_front(&hcan_comm.rx_buf, &rx_msg));
+    TEST_ASSERT_NOT_NULL(_can_comm_rx_peek());
 }
 
 void test_can_comm_rx_add_added_payload() {
@@ -162,10 +269,178 @@ void test_can_comm_rx_add_added_payload() {
     can_comm_enable_all();
     can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
 
-    CanMessage rx_msg;
-    ring_buffer_pop_front(&hcan_comm.rx_buf, &rx_msg);
+    CanMessage * rx_msg = _can_comm_rx_peek();
+
+    TEST_ASSERT_NOT_NULL(rx_msg);
+    TEST_ASSERT_EQUAL_MEMORY(data, rx_msg->payload.rx, 4);
+}
+
+void test_can_comm_rx_add_overrun() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    for (size_t i = 0U; i < CAN_COMM_RX_QUEUE_SIZE; ++i)
+        TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4));
+    TEST_ASSERT_EQUAL(CAN_COMM_OVERRUN, can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4));
+}
+
+void test_can_comm_rx_add_wrap() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // The free-running indices are still valid after they overflow
+    atomic_store(&hcan_comm.rx_queue.head, SIZE_MAX - 1U);
+    atomic_store(&hcan_comm.rx_queue.tail, SIZE_MAX - 1U);
+    can_comm_enable_all();
+    for (size_t i = 0U; i < CAN_COMM_RX_QUEUE_SIZE; ++i) {
+        data[0] = i;
+        TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4));
+    }
+    TEST_ASSERT_EQUAL(CAN_COMM_OVERRUN, can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4));
+    for (size_t i = 0U; i < CAN_COMM_RX_QUEUE_SIZE; ++i) {
+        CanMessage * rx_msg = _can_comm_rx_peek();
+        TEST_ASSERT_NOT_NULL(rx_msg);
+        TEST_ASSERT_EQUAL(i, rx_msg->payload.rx[0]);
+        _can_comm_rx_release();
+    }
+    TEST_ASSERT_NULL(_can_comm_rx_peek());
+}
+
+void test_can_comm_routine_rx_batch() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    for (size_t i = 0U; i < 5U; ++i)
+        can_comm_rx_add(BMS_CELLBOARD_STATUS_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+
+    // Every received message is handled by a single call
+    can_comm_routine();
+    TEST_ASSERT_NULL(_can_comm_rx_peek());
+    TEST_ASSERT_TRUE(can_comm_is_idle());
+}
+
+void test_can_comm_routine_rx_not_handled() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // Messages without a handler are not deserialized
+    TEST_ASSERT_NULL(can_comm_deserialize[BMS_CELLBOARD_STATUS_INDEX]);
+    can_comm_enable_all();
+    can_comm_rx_add(BMS_CELLBOARD_STATUS_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_routine());
+    TEST_ASSERT_NULL(_can_comm_rx_peek());
+}
+
+void test_can_comm_tables() {
+    // Every canlib message sent or received by the cellboard has the identifier given by canlib
+    size_t count = 0U;
+    for (can_index_t index = 0U; index < bms_MESSAGE_COUNT; ++index) {
+        if (can_comm_serialize[index] == NULL && can_comm_deserialize[index] == NULL)
+            continue;
+        TEST_ASSERT_EQUAL(bms_id_from_index(index), can_comm_id[index]);
+        TEST_ASSERT_EQUAL(index, bms_index_from_id(can_comm_id[index]));
+        ++count;
+    }
+    TEST_ASSERT_NOT_EQUAL(0U, count);
+    TEST_ASSERT_NOT_NULL(can_comm_serialize[BMS_CELLBOARD_STATUS_INDEX]);
+    TEST_ASSERT_NULL(can_comm_serialize[BMS_CELLBOARD_FLASH_REQUEST_INDEX]);
+    TEST_ASSERT_NOT_NULL(can_comm_deserialize[BMS_CELLBOARD_FLASH_REQUEST_INDEX]);
+}
+
+void test_can_comm_get_rx_ids() {
+    can_id_t ids[CAN_COMM_MESSAGE_COUNT];
+    const size_t count = can_comm_get_rx_ids(ids, CAN_COMM_MESSAGE_COUNT);
+
+    // Only the messages with a handler are received
+    bool flash_request = false;
+    for (size_t i = 0U; i < count; ++i) {
+        TEST_ASSERT_NOT_EQUAL(bms_id_from_index(BMS_CELLBOARD_STATUS_INDEX), ids[i]);
+        flash_request |= ids[i] == bms_id_from_index(BMS_CELLBOARD_FLASH_REQUEST_INDEX);
+    }
+    TEST_ASSERT_TRUE(flash_request);
+    TEST_ASSERT_EQUAL(1U, can_comm_get_rx_ids(ids, 1U));
+    TEST_ASSERT_EQUAL(0U, can_comm_get_rx_ids(NULL, CAN_COMM_MESSAGE_COUNT));
+}
+
+void test_can_comm_get_rx_index() {
+    can_id_t ids[CAN_COMM_MESSAGE_COUNT];
+    const size_t count = can_comm_get_rx_ids(ids, CAN_COMM_MESSAGE_COUNT);
+
+    // Each filter is mapped to the index of the identifier it accepts
+    for (size_t i = 0U; i < count; ++i)
+        TEST_ASSERT_EQUAL(ids[i], bms_id_from_index(can_comm_get_rx_index(i)));
+    TEST_ASSERT_EQUAL(CAN_COMM_MESSAGE_COUNT, can_comm_get_rx_index(count));
+}
+
+/**
+ * @brief Add the received messages as the reception interrupt would do
+ *
+ * @details The payload of each message contains its sequence number
+ */
+void * rx_producer(void * arg) {
+    const bool * const done = arg;
+    uint8_t data[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE] = { 0U };
+    for (uint32_t seq = 0U; seq < STRESS_MESSAGE_COUNT; ++seq) {
+        memcpy(data, &seq, sizeof(seq));
+        const can_index_t index = seq % bms_MESSAGE_COUNT;
+        while (can_comm_rx_add(index, CAN_FRAME_TYPE_DATA, data, sizeof(data)) == CAN_COMM_OVERRUN) {
+            if (*done)
+                return NULL;
+            // Let the consumer run when there is a single core
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_can_comm_rx_stress_order() {
+    bool done = false;
+    pthread_t producer;
+
+    can_comm_enable_all();
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, rx_producer, &done));
+
+    // Every message is received once, in order and with its payload intact
+    uint32_t errors = 0U;
+    for (uint32_t seq = 0U; seq < STRESS_MESSAGE_COUNT; ) {
+        CanMessage * rx_msg = _can_comm_rx_peek();
+        if (rx_msg == NULL) {
+            sched_yield();
+            continue;
+        }
+        uint32_t rx_seq = 0U;
+        memcpy(&rx_seq, rx_msg->payload.rx, sizeof(rx_seq));
+        if (rx_seq != seq || rx_msg->index != seq % bms_MESSAGE_COUNT || rx_msg->frame_type != CAN_FRAME_TYPE_DATA)
+            ++errors;
+        _can_comm_rx_release();
+        ++seq;
+    }
+    done = true;
+    pthread_join(producer, NULL);
+
+    TEST_ASSERT_EQUAL(0U, errors);
+    TEST_ASSERT_NULL(_can_comm_rx_peek());
+}
+
+void test_can_comm_rx_stress_routine() {
+    bool done = false;
+    pthread_t producer;
+
+    // The routine keeps up with the producer without losing messages or blocking
+    can_comm_enable_all();
+    can_comm_disable(CAN_COMM_TX_ENABLE_BIT);
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, rx_producer, &done));
+    size_t handled = 0U;
+    while (handled < STRESS_MESSAGE_COUNT) {
+        const size_t tail = atomic_load(&hcan_comm.rx_queue.tail);
+        can_comm_routine();
+        handled += atomic_load(&hcan_comm.rx_queue.tail) - tail;
+        if (atomic_load(&hcan_comm.rx_queue.tail) == tail)
+            sched_yield();
+    }
+    done = true;
+    pthread_join(producer, NULL);
 
-    TEST_ASSERT_EQUAL_MEMORY(data, rx_msg.payload.rx, 4);
+    TEST_ASSERT_EQUAL(STRESS_MESSAGE_COUNT, handled);
+    TEST_ASSERT_TRUE(can_comm_is_idle());
 }
 
 
@@ -180,7 +455,7 @@ void test_can_comm_tx_add_disabled() {
 
 void test_can_comm_tx_add_invalid_index() {
     can_comm_enable_all();
-    CanCommReturnCode ret = can_comm_tx_add(bms_MESSAGE_COUNT, CAN_FRAME_TYPE_DATA, NULL, 0);
+    CanCommReturnCode ret = can_comm_tx_add(CAN_COMM_MESSAGE_COUNT, CAN_FRAME_TYPE_DATA, NULL, 0);
     TEST_ASSERT_EQUAL(CAN_COMM_INVALID_INDEX, ret);
 }
 
@@ -192,7 +467,7 @@ void test_can_comm_tx_add_null() {
 
 void test_can_comm_tx_add_invalid_payload_size() {
     can_comm_enable_all();
-    CanCommReturnCode ret = can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, (void*)0x01, CELLBOARD_CAN_MAX_PAYLOAD_BYTE_SIZE+1);
+    CanCommReturnCode ret = can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, (void*)0x01, CAN_COMM_TX_MAILBOX_BYTE_SIZE+1);
     TEST_ASSERT_EQUAL(CAN_COMM_INVALID_PAYLOAD_SIZE, ret);
 }
 
@@ -213,8 +488,8 @@ void test_can_comm_tx_add_added() {
     can_comm_enable_all();
     CanCommReturnCode ret = can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, (void*)(0x01), 0);
 
-    CanMessage tx_msg;
-    TEST_ASSERT_EQUAL(RING_BUFFER_OK, ring_buffer_pop_front(&hcan_comm.tx_buf, &tx_msg));
+    TEST_ASSERT_TRUE(can_comm_tx_is_pending(0));
+    TEST_ASSERT_EQUAL(1U, can_comm_tx_get_pending_count());
 }
 
 void test_can_comm_tx_add_added_payload() {
@@ -223,12 +498,465 @@ void test_can_comm_tx_add_added_payload() {
     can_comm_enable_all();
     can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
 
-    CanMessage tx_msg;
-    ring_buffer_pop_front(&hcan_comm.tx_buf, &tx_msg);
+    TEST_ASSERT_EQUAL_MEMORY(data, hcan_comm.tx_mailbox[can_comm_tx_position[0]], 4);
+}
+
+void test_can_comm_tx_add_overwrite_pending() {
+    uint8_t old_data[] = {0x01, 0x02, 0x03, 0x04};
+    uint8_t new_data[] = {0x05, 0x06, 0x07, 0x08};
+
+    can_comm_enable_all();
+    can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, old_data, 4);
+    can_comm_tx_add(1, CAN_FRAME_TYPE_DATA, old_data, 4);
+    TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, new_data, 4));
+
+    // The pending message is updated in place and sent only once
+    TEST_ASSERT_EQUAL(2U, can_comm_tx_get_pending_count());
+    TEST_ASSERT_EQUAL_MEMORY(new_data, hcan_comm.tx_mailbox[can_comm_tx_position[0]], 4);
+    tx_flush();
+    TEST_ASSERT_EQUAL(2U, sent_count);
+    TEST_ASSERT_FALSE(can_comm_tx_is_pending(0));
+}
+
+void test_can_comm_tx_add_order() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    can_comm_tx_add(2, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(1, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(2, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+
+    // The messages are sent in order of their identifier regardless of the order of addition
+    TEST_ASSERT_EQUAL(3U, sent_count);
+    TEST_ASSERT_LESS_THAN(sent_ids[1], sent_ids[0]);
+    TEST_ASSERT_LESS_THAN(sent_ids[2], sent_ids[1]);
+}
+
+void test_can_comm_tx_priority_order() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // Every message sent by the cellboard added from the last one
+    can_comm_enable_all();
+    size_t count = 0U;
+    for (can_index_t index = CAN_COMM_MESSAGE_COUNT - 1; index >= 0; --index) {
+        if (can_comm_tx_add(index, CAN_FRAME_TYPE_DATA, data, 4) == CAN_COMM_OK)
+            ++count;
+    }
+    tx_flush();
+
+    TEST_ASSERT_EQUAL(count, sent_count);
+    for (size_t i = 1U; i < count; ++i)
+        TEST_ASSERT_LESS_THAN(sent_ids[i], sent_ids[i - 1U]);
+}
+
+void test_can_comm_tx_priority_preempt() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    can_index_t lowest = CAN_COMM_MESSAGE_COUNT;
+    can_index_t highest = CAN_COMM_MESSAGE_COUNT;
+    for (can_index_t index = 0; index < CAN_COMM_MESSAGE_COUNT; ++index) {
+        if (can_comm_serialize[index] == NULL)
+            continue;
+        if (lowest == CAN_COMM_MESSAGE_COUNT || can_comm_id[index] < can_comm_id[lowest])
+            lowest = index;
+        if (highest == CAN_COMM_MESSAGE_COUNT || can_comm_id[index] > can_comm_id[highest])
+            highest = index;
+    }
+
+    // A message added while a lower priority one is waiting is sent first
+    can_comm_enable_all();
+    hw_free = 0U;
+    can_comm_tx_add(highest, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_attempt();
+    can_comm_tx_add(lowest, CAN_FRAME_TYPE_DATA, data, 4);
+    hw_free = 1U;
+    tx_attempt();
+    TEST_ASSERT_EQUAL(1U, sent_count);
+    TEST_ASSERT_EQUAL(can_comm_id[lowest], sent_ids[0]);
+    TEST_ASSERT_TRUE(can_comm_tx_is_pending(highest));
+}
+
+void test_can_comm_tx_priority_under_load() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    can_index_t tx[CAN_COMM_MESSAGE_COUNT];
+    size_t tx_count = 0U;
+    for (can_index_t index = 0; index < CAN_COMM_MESSAGE_COUNT; ++index) {
+        if (can_comm_serialize[index] != NULL)
+            tx[tx_count++] = index;
+    }
+
+    /*
+     * The messages are added faster than they are sent so that the queue is
+     * never empty, every frame that leaves has the lowest identifier among
+     * the ones waiting at that moment
+     */
+    can_comm_enable_all();
+    uint32_t seed = 1U;
+    for (size_t i = 0U; i < STRESS_MESSAGE_COUNT; ++i) {
+        for (size_t j = 0U; j < 2U; ++j) {
+            seed = seed * 1103515245U + 12345U;
+            can_comm_tx_add(tx[(seed >> 16U) % tx_count], CAN_FRAME_TYPE_DATA, data, 4);
+        }
+
+        const can_id_t expected = tx_lowest_pending_id();
+        const size_t before = sent_count;
+        hw_free = 1U;
+        tx_attempt();
+        TEST_ASSERT_EQUAL(before + 1U, sent_count);
+        TEST_ASSERT_EQUAL(expected, last_sent_id);
+    }
+}
+
+void test_can_comm_tx_add_no_overrun() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // Every message can be added any number of times without draining the queue
+    can_comm_enable_all();
+    size_t count = 0U;
+    for (size_t i = 0U; i < 10U; ++i) {
+        count = 0U;
+        for (can_index_t index = 0; index < CAN_COMM_MESSAGE_COUNT; ++index) {
+            if (can_comm_serialize[index] == NULL)
+                continue;
+            TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_tx_add(index, CAN_FRAME_TYPE_DATA, data, 4));
+            ++count;
+        }
+    }
+    TEST_ASSERT_EQUAL(count, can_comm_tx_get_pending_count());
+}
+
+void test_can_comm_tx_add_not_sent() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // Only the messages sent by the cellboard can be added
+    can_comm_enable_all();
+    TEST_ASSERT_EQUAL(CAN_COMM_INVALID_INDEX, can_comm_tx_add(BMS_CELLBOARD_FLASH_REQUEST_INDEX, CAN_FRAME_TYPE_DATA, data, 4));
+    TEST_ASSERT_EQUAL(CAN_COMM_INVALID_INDEX, can_comm_send_immediate(BMS_CELLBOARD_FLASH_REQUEST_INDEX, CAN_FRAME_TYPE_DATA, data, 4));
+    TEST_ASSERT_EQUAL(0U, can_comm_tx_get_pending_count());
+}
+
+void test_can_comm_tx_busy_keeps_message() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    hw_free = 0U;
+    can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(1, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_attempt();
+
+    // The messages wait inside their mailboxes until the hardware has room for them
+    TEST_ASSERT_EQUAL(0U, sent_count);
+    TEST_ASSERT_TRUE(can_comm_tx_is_pending(0));
+    TEST_ASSERT_TRUE(can_comm_tx_is_pending(1));
+    tx_flush();
+    TEST_ASSERT_EQUAL(2U, sent_count);
+    TEST_ASSERT_EQUAL(CELLBOARD_MIN(can_comm_id[0], can_comm_id[1]), sent_ids[0]);
+    TEST_ASSERT_EQUAL(CELLBOARD_MAX(can_comm_id[0], can_comm_id[1]), sent_ids[1]);
+}
+
+void test_can_comm_tx_cache_hit() {
+    size_t byte_size = 0U;
+    const uint8_t * const payload = (const uint8_t *)identity_get_version_canlib_payload(&byte_size);
+
+    // An unchanged payload is serialized only once
+    can_comm_enable_all();
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, payload, byte_size);
+    tx_flush();
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, payload, byte_size);
+    tx_flush();
+    TEST_ASSERT_EQUAL(2U, sent_count);
+    TEST_ASSERT_EQUAL_MEMORY(sent_data[0], sent_data[1], CAN_COMM_MAX_PAYLOAD_BYTE_SIZE);
+    TEST_ASSERT_EQUAL(1U, can_comm_get_tx_cache_miss_count());
+    TEST_ASSERT_EQUAL(1U, can_comm_get_tx_cache_hit_count());
+}
+
+void test_can_comm_tx_cache_dirty() {
+    size_t byte_size = 0U;
+    const uint8_t * const payload = (const uint8_t *)identity_get_version_canlib_payload(&byte_size);
+
+    // The payload is serialized again after the producer notifies a change
+    can_comm_enable_all();
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, payload, byte_size);
+    tx_flush();
+    can_comm_tx_set_dirty(BMS_CELLBOARD_VERSION_INDEX);
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, payload, byte_size);
+    tx_flush();
+    TEST_ASSERT_EQUAL(2U, can_comm_get_tx_cache_miss_count());
+    TEST_ASSERT_EQUAL(0U, can_comm_get_tx_cache_hit_count());
+}
+
+void test_can_comm_tx_cache_dirty_before_add() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // A change notified while the message is waiting is applied at the next addition
+    can_comm_enable_all();
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    hw_free = 0U;
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_attempt();
+    can_comm_tx_set_dirty(BMS_CELLBOARD_VERSION_INDEX);
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    TEST_ASSERT_EQUAL(2U, sent_count);
+    TEST_ASSERT_EQUAL(2U, can_comm_get_tx_cache_miss_count());
+    TEST_ASSERT_EQUAL(0U, can_comm_get_tx_cache_hit_count());
+}
+
+void test_can_comm_tx_cache_not_cached() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // The payloads that change at every transmission are always serialized
+    can_comm_enable_all();
+    for (size_t i = 0U; i < 3U; ++i) {
+        can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+        tx_flush();
+    }
+    TEST_ASSERT_EQUAL(3U, can_comm_get_tx_cache_miss_count());
+    TEST_ASSERT_EQUAL(0U, can_comm_get_tx_cache_hit_count());
+}
+
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+
+void test_can_comm_tx_add_starts_transmission() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    hw_free = 1U;
+    TEST_ASSERT_EQUAL(CAN_COMM_OK, can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, data, 4));
+
+    // The message is sent without waiting for the routine inside a critical section
+    TEST_ASSERT_EQUAL(1U, sent_count);
+    TEST_ASSERT_EQUAL(1U, sent_cs_depth);
+    TEST_ASSERT_EQUAL(0U, cs_depth);
+    TEST_ASSERT_FALSE(can_comm_tx_is_pending(0));
+}
+
+void test_can_comm_tx_pump_fill() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    for (can_index_t index = 0; index < 4; ++index)
+        can_comm_tx_add(index, CAN_FRAME_TYPE_DATA, data, 4);
+
+    // Every call fills the hardware with as many messages as it can accept
+    hw_free = 3U;
+    can_comm_tx_pump();
+    TEST_ASSERT_EQUAL(3U, sent_count);
+    TEST_ASSERT_EQUAL(1U, can_comm_tx_get_pending_count());
+    hw_free = 3U;
+    can_comm_tx_pump();
+    TEST_ASSERT_EQUAL(4U, sent_count);
+    TEST_ASSERT_EQUAL(0U, can_comm_tx_get_pending_count());
+}
+
+void test_can_comm_tx_pump_disabled() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_disable(CAN_COMM_TX_ENABLE_BIT);
+    hw_free = SIZE_MAX;
+    can_comm_tx_pump();
+    TEST_ASSERT_EQUAL(0U, sent_count);
+}
+
+void test_can_comm_is_idle_tx_pending() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // The main loop is not needed to send the pending messages
+    can_comm_enable_all();
+    can_comm_tx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    TEST_ASSERT_TRUE(can_comm_tx_is_pending(0));
+    TEST_ASSERT_TRUE(can_comm_is_idle());
+}
+
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+
+/** @brief Send a message added at the given time and notify its transmission event at another time */
+void stats_send(const can_index_t index, const uint16_t enqueue_time, const uint16_t event_time) {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    timestamp = enqueue_time;
+    can_comm_tx_add(index, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    can_comm_stats_notify_tx_event(can_comm_id[index], event_time);
+}
+
+void test_can_comm_stats_init_null() {
+    TEST_ASSERT_EQUAL(CAN_COMM_NULL_POINTER, can_comm_stats_init(NULL));
+}
+
+void test_can_comm_stats_get_tx_invalid() {
+    TEST_ASSERT_NULL(can_comm_stats_get_tx(CAN_COMM_MESSAGE_COUNT));
+    TEST_ASSERT_NULL(can_comm_stats_get_tx(BMS_CELLBOARD_FLASH_REQUEST_INDEX));
+    TEST_ASSERT_NOT_NULL(can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX));
+}
+
+void test_can_comm_stats_latency() {
+    can_comm_enable_all();
+    hw_free = 0U;
+    stats_send(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, 100U, 400U);
+
+    // The latency goes from the addition to the mailbox to the start of the frame
+    const CanCommTxStats * const stats = can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX);
+    TEST_ASSERT_EQUAL(1U, stats->sent);
+    TEST_ASSERT_EQUAL(300U, stats->latency_max);
+    TEST_ASSERT_EQUAL(1U, stats->latency_hist[2U]);
+}
+
+void test_can_comm_stats_latency_bins() {
+    const uint16_t latencies[] = { 0U, 127U, 128U, 255U, 256U, 4095U, 4096U, 8191U, 8192U, UINT16_MAX };
+    const size_t bins[] = { 0U, 0U, 1U, 1U, 2U, 5U, 6U, 6U, 7U, 7U };
+
+    can_comm_enable_all();
+    for (size_t i = 0U; i < sizeof(latencies) / sizeof(latencies[0U]); ++i)
+        stats_send(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, 1000U, 1000U + latencies[i]);
+
+    uint32_t expected[CAN_COMM_STATS_LATENCY_BIN_COUNT] = { 0U };
+    for (size_t i = 0U; i < sizeof(bins) / sizeof(bins[0U]); ++i)
+        ++expected[bins[i]];
+    const CanCommTxStats * const stats = can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, stats->latency_hist, CAN_COMM_STATS_LATENCY_BIN_COUNT);
+    TEST_ASSERT_EQUAL(UINT16_MAX, stats->latency_max);
+}
+
+void test_can_comm_stats_latency_wrap() {
+    // The timestamp counter wraps around while the message is waiting
+    can_comm_enable_all();
+    stats_send(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, UINT16_MAX - 35U, 100U);
+    TEST_ASSERT_EQUAL(136U, can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX)->latency_max);
+}
+
+void test_can_comm_stats_overwritten() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // The payload replaced before being sent is lost but the waiting time is kept
+    can_comm_enable_all();
+    hw_free = 0U;
+    timestamp = 10U;
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_attempt();
+    timestamp = 20U;
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    can_comm_stats_notify_tx_event(can_comm_id[BMS_CELLBOARD_CELLS_VOLTAGE_INDEX], 50U);
+
+    const CanCommTxStats * const stats = can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX);
+    TEST_ASSERT_EQUAL(1U, stats->overwritten);
+    TEST_ASSERT_EQUAL(1U, stats->sent);
+    TEST_ASSERT_EQUAL(40U, stats->latency_max);
+}
+
+void test_can_comm_stats_in_flight_oldest() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
 
-    TEST_ASSERT_EQUAL_MEMORY(data, tx_msg.payload.tx, 4);
+    // Two frames of the same message inside the hardware, only the oldest is measured
+    can_comm_enable_all();
+    timestamp = 10U;
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    timestamp = 30U;
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    can_comm_stats_notify_tx_event(can_comm_id[BMS_CELLBOARD_CELLS_VOLTAGE_INDEX], 50U);
+    can_comm_stats_notify_tx_event(can_comm_id[BMS_CELLBOARD_CELLS_VOLTAGE_INDEX], 60U);
+
+    const CanCommTxStats * const stats = can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX);
+    TEST_ASSERT_EQUAL(2U, stats->sent);
+    TEST_ASSERT_EQUAL(1U, stats->latency_hist[0U]);
+    TEST_ASSERT_EQUAL(40U, stats->latency_max);
 }
 
+void test_can_comm_stats_send_immediate() {
+    // The message sent immediately does not wait inside its mailbox
+    can_comm_enable_all();
+    hw_free = SIZE_MAX;
+    timestamp = 500U;
+    can_comm_send_immediate(BMS_CELLBOARD_STATUS_INDEX, CAN_FRAME_TYPE_DATA, (void*)0x01, 0);
+    can_comm_stats_notify_tx_event(can_comm_id[BMS_CELLBOARD_STATUS_INDEX], 520U);
+    TEST_ASSERT_EQUAL(20U, can_comm_stats_get_tx(BMS_CELLBOARD_STATUS_INDEX)->latency_max);
+    TEST_ASSERT_EQUAL(0U, cs_depth);
+}
+
+void test_can_comm_stats_errors() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    // A busy hardware is not an error
+    can_comm_enable_all();
+    hw_free = 0U;
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_attempt();
+    TEST_ASSERT_EQUAL(0U, can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX)->errors);
+
+    hw_ret = CAN_COMM_TRANSMISSION_ERROR;
+    tx_flush();
+    TEST_ASSERT_EQUAL(1U, can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX)->errors);
+    TEST_ASSERT_FALSE(hcan_comm.tx_in_flight[can_comm_tx_position[BMS_CELLBOARD_CELLS_VOLTAGE_INDEX]]);
+}
+
+void test_can_comm_stats_tx_event_lookup() {
+    // Every message sent by the cellboard is found from its identifier
+    for (can_index_t index = 0; index < CAN_COMM_MESSAGE_COUNT; ++index) {
+        if (can_comm_serialize[index] != NULL)
+            can_comm_stats_notify_tx_event(can_comm_id[index], 0U);
+    }
+    for (can_index_t index = 0; index < CAN_COMM_MESSAGE_COUNT; ++index) {
+        if (can_comm_serialize[index] != NULL)
+            TEST_ASSERT_EQUAL(1U, can_comm_stats_get_tx(index)->sent);
+    }
+}
+
+void test_can_comm_stats_tx_event_unknown() {
+    // The events of the messages not sent by the cellboard are ignored
+    can_comm_stats_notify_tx_event(can_comm_id[BMS_CELLBOARD_FLASH_REQUEST_INDEX], 0U);
+    can_comm_stats_notify_tx_event(CAN_COMM_ID_MASK, 0U);
+    for (size_t position = 0U; position < CAN_COMM_TX_SENT_COUNT; ++position)
+        TEST_ASSERT_EQUAL(0U, can_comm_stats_get()->tx[position].sent);
+}
+
+void test_can_comm_stats_tx_pending_max() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    hw_free = 0U;
+    can_comm_tx_add(BMS_CELLBOARD_STATUS_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(BMS_CELLBOARD_VERSION_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_tx_add(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, CAN_FRAME_TYPE_DATA, data, 4);
+    tx_flush();
+    TEST_ASSERT_EQUAL(3U, can_comm_stats_get()->tx_pending_max);
+}
+
+void test_can_comm_stats_rx_queue() {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+
+    can_comm_enable_all();
+    for (size_t i = 0U; i < 5U; ++i)
+        can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    can_comm_routine();
+    can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    TEST_ASSERT_EQUAL(5U, can_comm_stats_get()->rx_queue_max);
+    TEST_ASSERT_EQUAL(0U, can_comm_stats_get()->rx_overrun);
+
+    for (size_t i = 0U; i < CAN_COMM_RX_QUEUE_SIZE + 2U; ++i)
+        can_comm_rx_add(0, CAN_FRAME_TYPE_DATA, data, 4);
+    TEST_ASSERT_EQUAL(CAN_COMM_RX_QUEUE_SIZE, can_comm_stats_get()->rx_queue_max);
+    TEST_ASSERT_EQUAL(3U, can_comm_stats_get()->rx_overrun);
+}
+
+void test_can_comm_stats_reset() {
+    can_comm_enable_all();
+    stats_send(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX, 0U, 10U);
+    can_comm_stats_reset();
+    TEST_ASSERT_EQUAL(0U, can_comm_stats_get_tx(BMS_CELLBOARD_CELLS_VOLTAGE_INDEX)->sent);
+    TEST_ASSERT_EQUAL(0U, can_comm_stats_get()->tx_pending_max);
+}
+
+#endif // CONF_CAN_COMM_STATS_ENABLE
+
 int main() {
     UNITY_BEGIN();
     RUN_TEST(test_can_comm_init_null);
@@ -251,9 +979,19 @@ int main() {
     RUN_TEST(test_can_comm_rx_add_null);
     RUN_TEST(test_can_comm_rx_add_invalid_payload_size);
     RUN_TEST(test_can_comm_rx_add_invalid_frame);
+    RUN_TEST(test_can_comm_rx_add_remote);
     RUN_TEST(test_can_comm_rx_add_ok);
     RUN_TEST(test_can_comm_rx_add_added);
     RUN_TEST(test_can_comm_rx_add_added_payload);
+    RUN_TEST(test_can_comm_rx_add_overrun);
+    RUN_TEST(test_can_comm_rx_add_wrap);
+    RUN_TEST(test_can_comm_routine_rx_batch);
+    RUN_TEST(test_can_comm_routine_rx_not_handled);
+    RUN_TEST(test_can_comm_tables);
+    RUN_TEST(test_can_comm_get_rx_ids);
+    RUN_TEST(test_can_comm_get_rx_index);
+    RUN_TEST(test_can_comm_rx_stress_order);
+    RUN_TEST(test_can_comm_rx_stress_routine);
     RUN_TEST(test_can_comm_tx_add_disabled);
     RUN_TEST(test_can_comm_tx_add_invalid_index);
     RUN_TEST(test_can_comm_tx_add_null);
@@ -262,6 +1000,40 @@ int main() {
     RUN_TEST(test_can_comm_tx_add_ok);
     RUN_TEST(test_can_comm_tx_add_added);
     RUN_TEST(test_can_comm_tx_add_added_payload);
+    RUN_TEST(test_can_comm_tx_add_overwrite_pending);
+    RUN_TEST(test_can_comm_tx_add_order);
+    RUN_TEST(test_can_comm_tx_priority_order);
+    RUN_TEST(test_can_comm_tx_priority_preempt);
+    RUN_TEST(test_can_comm_tx_priority_under_load);
+    RUN_TEST(test_can_comm_tx_add_no_overrun);
+    RUN_TEST(test_can_comm_tx_add_not_sent);
+    RUN_TEST(test_can_comm_tx_busy_keeps_message);
+    RUN_TEST(test_can_comm_tx_cache_hit);
+    RUN_TEST(test_can_comm_tx_cache_dirty);
+    RUN_TEST(test_can_comm_tx_cache_dirty_before_add);
+    RUN_TEST(test_can_comm_tx_cache_not_cached);
+#ifdef CONF_CAN_COMM_TX_ISR_ENABLE
+    RUN_TEST(test_can_comm_tx_add_starts_transmission);
+    RUN_TEST(test_can_comm_tx_pump_fill);
+    RUN_TEST(test_can_comm_tx_pump_disabled);
+    RUN_TEST(test_can_comm_is_idle_tx_pending);
+#endif // CONF_CAN_COMM_TX_ISR_ENABLE
+#ifdef CONF_CAN_COMM_STATS_ENABLE
+    RUN_TEST(test_can_comm_stats_init_null);
+    RUN_TEST(test_can_comm_stats_get_tx_invalid);
+    RUN_TEST(test_can_comm_stats_latency);
+    RUN_TEST(test_can_comm_stats_latency_bins);
+    RUN_TEST(test_can_comm_stats_latency_wrap);
+    RUN_TEST(test_can_comm_stats_overwritten);
+    RUN_TEST(test_can_comm_stats_in_flight_oldest);
+    RUN_TEST(test_can_comm_stats_send_immediate);
+    RUN_TEST(test_can_comm_stats_errors);
+    RUN_TEST(test_can_comm_stats_tx_event_lookup);
+    RUN_TEST(test_can_comm_stats_tx_event_unknown);
+    RUN_TEST(test_can_comm_stats_tx_pending_max);
+    RUN_TEST(test_can_comm_stats_rx_queue);
+    RUN_TEST(test_can_comm_stats_reset);
+#endif // CONF_CAN_COMM_STATS_ENABLE
     return UNITY_END();
 }
 
@@ -0,0 +1,174 @@
+/**
+ * @file test_idle.c
+ * @date 2024-10-16
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ *
+ * @brief Test functions for the idle module
+ */
+
+#include "unity.h"
+#include "idle.h"
+#include "can-comm.h"
+#include "timebase.h"
+#include "cellboard-def.h"
+
+extern _IdleHandler hidle;
+
+#ifdef CONF_IDLE_MODULE_ENABLE
+
+size_t sleep_count = 0U;
+size_t cs_depth = 0U;
+IdleWakeReason sleep_reason = IDLE_WAKE_REASON_COUNT;
+
+static void cs_enter(void) {
+    ++cs_depth;
+}
+
+static void cs_exit(void) {
+    --cs_depth;
+}
+
+/** @brief Simulate an interrupt that wakes up the microcontroller */
+static void sleep(void) {
+    TEST_ASSERT_EQUAL(1U, cs_depth);
+    ++sleep_count;
+    idle_notify(sleep_reason);
+}
+
+static CanCommReturnCode can_send(
+    const can_id_t id,
+    const CanFrameType frame_type,
+    const uint8_t * const data,
+    const size_t size)
+{
+    return CAN_COMM_OK;
+}
+
+static void task(void) { }
+
+void setUp() {
+    sleep_count = 0U;
+    cs_depth = 0U;
+    sleep_reason = IDLE_WAKE_REASON_COUNT;
+
+    // Run the timebase until no task is due
+    timebase_init(1U, NULL, NULL);
+    for (size_t i = 0U; i < TASKS_COUNT; ++i)
+        tasks_get_task(i)->exec = task;
+    timebase_set_enable(true);
+    for (size_t i = 0U; i < TASKS_COUNT; ++i)
+        timebase_routine();
+
+    can_comm_init(can_send, cs_enter, cs_exit);
+    can_comm_enable_all();
+
+    idle_init(sleep, cs_enter, cs_exit);
+    idle_set_enable(true);
+}
+
+void tearDown() {}
+
+void test_idle_init_null() {
+    TEST_ASSERT_EQUAL(IDLE_NULL_POINTER, idle_init(NULL, cs_enter, cs_exit));
+    TEST_ASSERT_EQUAL(IDLE_NULL_POINTER, idle_init(sleep, NULL, cs_exit));
+    TEST_ASSERT_EQUAL(IDLE_NULL_POINTER, idle_init(sleep, cs_enter, NULL));
+}
+
+void test_idle_init_ok() {
+    TEST_ASSERT_EQUAL(IDLE_OK, idle_init(sleep, cs_enter, cs_exit));
+    TEST_ASSERT_FALSE(hidle.enabled);
+}
+
+void test_idle_set_enable_uninitialized() {
+    hidle.sleep = NULL;
+    idle_set_enable(true);
+    TEST_ASSERT_FALSE(hidle.enabled);
+}
+
+void test_idle_routine_disabled() {
+    idle_set_enable(false);
+    TEST_ASSERT_EQUAL(IDLE_DISABLED, idle_routine());
+    TEST_ASSERT_EQUAL(0U, sleep_count);
+}
+
+void test_idle_routine_sleep() {
+    TEST_ASSERT_EQUAL(IDLE_OK, idle_routine());
+    TEST_ASSERT_EQUAL(1U, sleep_count);
+    TEST_ASSERT_EQUAL(1U, idle_get_sleep_count());
+    TEST_ASSERT_EQUAL(0U, cs_depth);
+}
+
+void test_idle_routine_busy_timebase() {
+    // Elapse time until a task is due
+    for (size_t i = 0U; i < 1000U; ++i)
+        timebase_inc_tick();
+    TEST_ASSERT_EQUAL(IDLE_BUSY, idle_routine());
+    TEST_ASSERT_EQUAL(0U, sleep_count);
+    TEST_ASSERT_EQUAL(0U, cs_depth);
+}
+
+void test_idle_routine_busy_can() {
+    uint8_t data[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE] = { 0U };
+    can_comm_rx_add(BMS_CELLBOARD_STATUS_INDEX, CAN_FRAME_TYPE_DATA, data, sizeof(data));
+    TEST_ASSERT_EQUAL(IDLE_BUSY, idle_routine());
+    TEST_ASSERT_EQUAL(0U, sleep_count);
+}
+
+void test_idle_routine_wake_reason() {
+    sleep_reason = IDLE_WAKE_REASON_CAN;
+    idle_routine();
+    sleep_reason = IDLE_WAKE_REASON_ADC;
+    idle_routine();
+    idle_routine();
+    TEST_ASSERT_EQUAL(1U, idle_get_wake_count(IDLE_WAKE_REASON_CAN));
+    TEST_ASSERT_EQUAL(2U, idle_get_wake_count(IDLE_WAKE_REASON_ADC));
+    TEST_ASSERT_EQUAL(0U, idle_get_wake_count(IDLE_WAKE_REASON_TIMEBASE));
+}
+
+void test_idle_routine_wake_reason_other() {
+    idle_routine();
+    TEST_ASSERT_EQUAL(1U, idle_get_wake_count(IDLE_WAKE_REASON_OTHER));
+}
+
+void test_idle_routine_ignore_reason_before_sleep() {
+    // Interrupts handled while awake are not counted as wake up reasons
+    idle_notify(IDLE_WAKE_REASON_CAN);
+    idle_routine();
+    TEST_ASSERT_EQUAL(0U, idle_get_wake_count(IDLE_WAKE_REASON_CAN));
+}
+
+void test_idle_get_loop_count() {
+    idle_routine();
+    for (size_t i = 0U; i < 1000U; ++i)
+        timebase_inc_tick();
+    idle_routine();
+    TEST_ASSERT_EQUAL(2U, idle_get_loop_count());
+    TEST_ASSERT_EQUAL(1U, idle_get_sleep_count());
+}
+
+void test_idle_get_wake_count_invalid() {
+    TEST_ASSERT_EQUAL(0U, idle_get_wake_count(IDLE_WAKE_REASON_COUNT));
+}
+
+#endif // CONF_IDLE_MODULE_ENABLE
+
+int main() {
+    UNITY_BEGIN();
+
+#ifdef CONF_IDLE_MODULE_ENABLE
+    RUN_TEST(test_idle_init_null);
+    RUN_TEST(test_idle_init_ok);
+    RUN_TEST(test_idle_set_enable_uninitialized);
+    RUN_TEST(test_idle_routine_disabled);
+    RUN_TEST(test_idle_routine_sleep);
+    RUN_TEST(test_idle_routine_busy_timebase);
+    RUN_TEST(test_idle_routine_busy_can);
+    RUN_TEST(test_idle_routine_wake_reason);
+    RUN_TEST(test_idle_routine_wake_reason_other);
+    RUN_TEST(test_idle_routine_ignore_reason_before_sleep);
+    RUN_TEST(test_idle_get_loop_count);
+    RUN_TEST(test_idle_get_wake_count_invalid);
+#endif // CONF_IDLE_MODULE_ENABLE
+
+    return UNITY_END();
+}
@@ -9,50 +9,149 @@
 #include "unity.h"
 #include "temp.h"
 #include "identity.h"
+#include "timebase.h"
 #include "cellboard-def.h"
 
 #define CELLBOARD_ID CELLBOARD_ID_1
 
 extern _TempHandler htemp;
 
+void temp_set_address_stub(const uint8_t address) {
+    CELLBOARD_UNUSED(address);
+}
+
+void temp_start_conversion_stub(void) { }
+
 void setUp() {
     identity_init(CELLBOARD_ID);
-    temp_init();
+    timebase_init(1U, NULL, NULL);
+    timebase_set_enable(true);
+    temp_init(temp_set_address_stub, temp_start_conversion_stub);
 }
 
 void tearDown() {}
 
 void test_temp_init() {
-    TEST_ASSERT_EQUAL(TEMP_OK, temp_init());
-    TEST_ASSERT_EQUAL(CELLBOARD_ID, htemp.can_payload.cellboard_id);
+    TEST_ASSERT_EQUAL(TEMP_OK, temp_init(temp_set_address_stub, temp_start_conversion_stub));
+    TEST_ASSERT_EQUAL(CELLBOARD_ID, htemp.temp_can_payload.cellboard_id);
+}
+
+void test_temp_init_null() {
+    TEST_ASSERT_EQUAL(TEMP_NULL_POINTER, temp_init(NULL, temp_start_conversion_stub));
+    TEST_ASSERT_EQUAL(TEMP_NULL_POINTER, temp_init(temp_set_address_stub, NULL));
 }
 
 void test_temp_update_value() {
-    TEST_ASSERT_EQUAL(TEMP_OK, temp_init());
-    TEST_ASSERT_EQUAL(TEMP_OK, temp_update_value(0, 0x01));
-    TEST_ASSERT_EQUAL(0x01, htemp.temperatures[0]);
+    TEST_ASSERT_EQUAL(TEMP_OK, temp_update_value(0U, 25.f));
+    TEST_ASSERT_EQUAL_FLOAT(25.f, htemp.temperatures[0U]);
 }
 
 void test_temp_update_values() {
-    TEST_ASSERT_EQUAL(TEMP_OK, temp_init());
-    TEST_ASSERT_EQUAL(TEMP_OUT_OF_BOUNDS, temp_update_values(0, NULL, CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT));
-    raw_temp_t values[2] = {0x01, 0x02};
-    TEST_ASSERT_EQUAL(TEMP_OK, temp_update_values(0, values, 2));
-    TEST_ASSERT_EQUAL(0x01, htemp.temperatures[0]);
-    TEST_ASSERT_EQUAL(0x02, htemp.temperatures[1]);
+    TEST_ASSERT_EQUAL(TEMP_OUT_OF_BOUNDS, temp_update_values(1U, NULL, CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT));
+    celsius_t values[2U] = { 25.f, 26.f };
+    TEST_ASSERT_EQUAL(TEMP_OK, temp_update_values(0U, values, 2U));
+    TEST_ASSERT_EQUAL_FLOAT(25.f, htemp.temperatures[0U]);
+    TEST_ASSERT_EQUAL_FLOAT(26.f, htemp.temperatures[1U]);
+}
+
+void test_temp_get_values() {
+    celsius_t values[CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT];
+    for (size_t i = 0U; i < CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT; ++i)
+        values[i] = 20.f + i * 0.5f;
+    temp_update_values(0U, values, CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT);
+
+    const cells_temp_t * const out = temp_get_values();
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(values, *out, CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT);
 }
 
-void test_temp_update_discharge_value() {
+void test_temp_get_cells_temp_canlib_payload() {
+    celsius_t values[CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT];
+    for (size_t i = 0U; i < CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT; ++i)
+        values[i] = 20.f + i * 0.5f;
+    temp_update_values(0U, values, CELLBOARD_SEGMENT_TEMP_SENSOR_COUNT);
+
+    size_t byte_size = 0U;
+    const bms_cellboard_cells_temperature_converted_t * const payload = temp_get_cells_temp_canlib_payload(&byte_size);
+    TEST_ASSERT_NOT_NULL(payload);
+    TEST_ASSERT_EQUAL(sizeof(htemp.temp_can_payload), byte_size);
+    TEST_ASSERT_EQUAL(CELLBOARD_ID, payload->cellboard_id);
+    TEST_ASSERT_EQUAL(0U, payload->offset);
+    TEST_ASSERT_EQUAL_FLOAT(values[0U], payload->temperature_0);
+    TEST_ASSERT_EQUAL_FLOAT(values[1U], payload->temperature_1);
+    TEST_ASSERT_EQUAL_FLOAT(values[2U], payload->temperature_2);
+    TEST_ASSERT_EQUAL_FLOAT(values[3U], payload->temperature_3);
 }
 
-void test_temp_update_discharge_values() {
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+/** @brief Send every group once to fill the values known by the receiver */
+static void adaptive_send_all(void) {
+    for (size_t i = 0U; i < TEMP_CAN_GROUP_COUNT; ++i)
+        temp_get_cells_temp_canlib_payload(NULL);
 }
 
-void test_temp_get_values() {
+void test_temp_adaptive_first_round() {
+    for (size_t i = 0U; i < TEMP_CAN_GROUP_COUNT; ++i) {
+        const bms_cellboard_cells_temperature_converted_t * const payload = temp_get_cells_temp_canlib_payload(NULL);
+        TEST_ASSERT_NOT_NULL(payload);
+        TEST_ASSERT_EQUAL(i * TEMP_CAN_GROUP_SIZE, payload->offset);
+    }
+    TEST_ASSERT_EQUAL(TEMP_CAN_GROUP_COUNT, temp_get_sent_frame_count());
+    TEST_ASSERT_EQUAL(0U, temp_get_saved_frame_count());
 }
 
+void test_temp_adaptive_unchanged() {
+    adaptive_send_all();
+    TEST_ASSERT_NULL(temp_get_cells_temp_canlib_payload(NULL));
+    TEST_ASSERT_EQUAL(TEMP_CAN_GROUP_COUNT, temp_get_sent_frame_count());
+    TEST_ASSERT_EQUAL(1U, temp_get_saved_frame_count());
+}
+
+void test_temp_adaptive_deadband() {
+    adaptive_send_all();
+
+    // A change inside the deadband is not sent
+    temp_update_value(TEMP_CAN_GROUP_SIZE + 1U, TEMP_DEADBAND_C * 0.5f);
+    TEST_ASSERT_NULL(temp_get_cells_temp_canlib_payload(NULL));
+
+    // Only the group of the value that moved outside the deadband is sent
+    temp_update_value(TEMP_CAN_GROUP_SIZE + 1U, TEMP_DEADBAND_C * 2.f);
+    const bms_cellboard_cells_temperature_converted_t * const payload = temp_get_cells_temp_canlib_payload(NULL);
+    TEST_ASSERT_NOT_NULL(payload);
+    TEST_ASSERT_EQUAL(TEMP_CAN_GROUP_SIZE, payload->offset);
+    TEST_ASSERT_EQUAL_FLOAT(TEMP_DEADBAND_C * 2.f, payload->temperature_1);
+    TEST_ASSERT_NULL(temp_get_cells_temp_canlib_payload(NULL));
+}
+
+void test_temp_adaptive_refresh() {
+    adaptive_send_all();
+    for (size_t i = 0U; i < TEMP_REFRESH_MS; ++i)
+        timebase_inc_tick();
+
+    // Every group is sent again after the refresh period even if unchanged
+    for (size_t i = 0U; i < TEMP_CAN_GROUP_COUNT; ++i)
+        TEST_ASSERT_NOT_NULL(temp_get_cells_temp_canlib_payload(NULL));
+    TEST_ASSERT_NULL(temp_get_cells_temp_canlib_payload(NULL));
+}
+
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+
 int main() {
 
     UNITY_BEGIN();
+
+    RUN_TEST(test_temp_init);
+    RUN_TEST(test_temp_init_null);
+    RUN_TEST(test_temp_update_value);
+    RUN_TEST(test_temp_update_values);
+    RUN_TEST(test_temp_get_values);
+    RUN_TEST(test_temp_get_cells_temp_canlib_payload);
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    RUN_TEST(test_temp_adaptive_first_round);
+    RUN_TEST(test_temp_adaptive_unchanged);
+    RUN_TEST(test_temp_adaptive_deadband);
+    RUN_TEST(test_temp_adaptive_refresh);
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+
     return UNITY_END();
 }
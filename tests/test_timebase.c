@@ -0,0 +1,826 @@
+/**
+ * @file test_timebase.c
+ * @date 2024-10-16
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ *
+ * @brief Test functions for the timebase module
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "timebase.h"
+#include "tasks.h"
+#include "watchdog.h"
+#include "identity.h"
+#include "cellboard-def.h"
+
+/** @brief Maximum number of task executions that can be recorded */
+#define TEST_TIMEBASE_LOG_SIZE (16384U)
+
+extern _TimebaseHandler htimebase;
+
+/**
+ * @brief Record of a single task execution
+ *
+ * @param t The tick in which the task was executed
+ * @param id The identifier of the executed task
+ */
+typedef struct {
+    ticks_t t;
+    TasksId id;
+} TestTimebaseExec;
+
+TestTimebaseExec exec_log[TEST_TIMEBASE_LOG_SIZE];
+size_t exec_count = 0U;
+
+Watchdog watchdogs[TIMEBASE_RUNNING_WATCHDOG_COUNT + 1U];
+size_t expired_count = 0U;
+size_t expired_exec_count = 0U;
+
+static void expire(void) {
+    ++expired_count;
+    expired_exec_count = exec_count;
+}
+
+uint32_t task_cost = 0U;
+uint32_t profiler_clock = 0U;
+
+static uint32_t profiler_clock_get(void) {
+    return profiler_clock;
+}
+
+static void record(const TasksId id) {
+    profiler_clock += task_cost;
+    if (exec_count < TEST_TIMEBASE_LOG_SIZE) {
+        exec_log[exec_count].t = timebase_get_tick();
+        exec_log[exec_count].id = id;
+    }
+    ++exec_count;
+}
+
+// Replace every task callback with a function that records its execution
+#define TASKS_X(NAME, ENABLED, START, INTERVAL, PRIORITY, POLICY, EXEC) \
+    static void record_##NAME(void) { record(TASKS_ID_##NAME); }
+TASKS_X_LIST
+#undef TASKS_X
+
+static void run(const ticks_t ticks) {
+    for (ticks_t i = 0U; i < ticks; ++i) {
+        timebase_routine();
+        timebase_inc_tick();
+    }
+}
+
+// Run the routine until every deferred task is executed
+static void flush(void) {
+    size_t count = 0U;
+    do {
+        count = exec_count;
+        timebase_routine();
+    } while (count != exec_count);
+}
+
+uint32_t clock_counter = 0U;
+uint32_t clock_alarm = 0U;
+size_t clock_alarm_count = 0U;
+
+static uint32_t clock_get(void) {
+    return clock_counter;
+}
+
+static void clock_set_alarm(const uint32_t counter) {
+    clock_alarm = counter;
+    ++clock_alarm_count;
+}
+
+static void setup_timebase(timebase_clock_get_callback_t get, timebase_clock_set_alarm_callback_t set_alarm) {
+    timebase_init(1U, get, set_alarm);
+
+#define TASKS_X(NAME, ENABLED, START, INTERVAL, PRIORITY, POLICY, EXEC) \
+    tasks_get_task(TASKS_ID_##NAME)->exec = record_##NAME;
+    TASKS_X_LIST
+#undef TASKS_X
+
+    exec_count = 0U;
+    timebase_set_enable(true);
+}
+
+void setUp() {
+    clock_counter = 0U;
+    clock_alarm = 0U;
+    clock_alarm_count = 0U;
+    task_cost = 0U;
+    profiler_clock = 0U;
+    setup_timebase(NULL, NULL);
+
+    for (size_t i = 0U; i < TIMEBASE_RUNNING_WATCHDOG_COUNT + 1U; ++i) {
+        memset(&watchdogs[i], 0U, sizeof(watchdogs[i]));
+        watchdog_init(&watchdogs[i], 10U * (i + 1U), expire);
+    }
+    expired_count = 0U;
+}
+
+void tearDown() {}
+
+void test_timebase_init_ok() {
+    TEST_ASSERT_EQUAL(TIMEBASE_OK, timebase_init(1U, NULL, NULL));
+}
+
+void test_timebase_init_resolution_zero() {
+    timebase_init(0U, NULL, NULL);
+    TEST_ASSERT_EQUAL(1U, timebase_get_resolution());
+}
+
+void test_timebase_inc_tick_disabled() {
+    timebase_set_enable(false);
+    TEST_ASSERT_EQUAL(TIMEBASE_DISABLED, timebase_inc_tick());
+    TEST_ASSERT_EQUAL(0U, timebase_get_tick());
+}
+
+void test_timebase_routine_disabled() {
+    timebase_set_enable(false);
+    TEST_ASSERT_EQUAL(TIMEBASE_DISABLED, timebase_routine());
+    TEST_ASSERT_EQUAL(0U, exec_count);
+}
+
+#ifdef CONF_TIMEBASE_WHEEL_ENABLE
+
+void test_timebase_wheel_init() {
+    // Every task is scheduled exactly once at its start time inside the wheel of its priority
+    size_t count = 0U;
+    for (size_t p = 0U; p < TASKS_PRIORITY_COUNT; ++p) {
+        const TimebaseTasksWheel * const wheel = &htimebase.scheduled_tasks[p];
+        for (size_t slot = 0U; slot < TIMEBASE_WHEEL_SLOT_COUNT; ++slot)
+            count += (size_t)__builtin_popcount(wheel->slots[slot]);
+    }
+    TEST_ASSERT_EQUAL(TASKS_COUNT, count);
+
+    for (TasksId i = 0U; i < TASKS_COUNT; ++i) {
+        const Task * const task = tasks_get_task(i);
+        const TimebaseTasksWheel * const wheel = &htimebase.scheduled_tasks[task->priority];
+        TEST_ASSERT_EQUAL(task->start, wheel->deadline[i]);
+        TEST_ASSERT_TRUE(CELLBOARD_BIT_GET(wheel->slots[TIMEBASE_WHEEL_SLOT(task->start)], i));
+    }
+}
+
+#endif // CONF_TIMEBASE_WHEEL_ENABLE
+
+void test_timebase_routine_first_tick() {
+    timebase_routine();
+
+    // All the high priority tasks are executed and the others only within the budget
+    size_t high = 0U, low = 0U;
+    for (size_t i = 0U; i < TASKS_COUNT; ++i) {
+        if (!tasks_is_enabled(i) || tasks_get_start(i) != 0U)
+            continue;
+        if (tasks_get_task(i)->priority == TASKS_PRIORITY_HIGH)
+            ++high;
+        else
+            ++low;
+    }
+    TEST_ASSERT_EQUAL(high + CELLBOARD_MIN(low, TIMEBASE_ROUTINE_BUDGET), exec_count);
+}
+
+void test_timebase_routine_tasks_deadline() {
+    const ticks_t ticks = 2100U;
+    run(ticks);
+
+    // Every task should run exactly at its start time plus a multiple of its interval
+    size_t expected = 0U;
+    for (size_t i = 0U; i < TASKS_COUNT; ++i) {
+        if (tasks_is_enabled(i))
+            expected += (ticks - 1U - tasks_get_start(i)) / tasks_get_interval(i) + 1U;
+    }
+    TEST_ASSERT_EQUAL(expected, exec_count);
+
+    // Tasks deferred because of the budget are delayed at most by a few ticks
+    const ticks_t max_delay = TASKS_COUNT / TIMEBASE_ROUTINE_BUDGET + 1U;
+    for (size_t i = 0U; i < exec_count && i < TEST_TIMEBASE_LOG_SIZE; ++i) {
+        const Task * const task = tasks_get_task(exec_log[i].id);
+        const ticks_t delay = (exec_log[i].t - task->start) % task->interval;
+        TEST_ASSERT_GREATER_OR_EQUAL(task->start, exec_log[i].t);
+        if (task->priority == TASKS_PRIORITY_HIGH)
+            TEST_ASSERT_EQUAL(0U, delay);
+        else
+            TEST_ASSERT_LESS_THAN(max_delay, delay);
+    }
+}
+
+void test_timebase_routine_tasks_order() {
+    run(500U);
+
+    // Tasks are executed in order of deadline
+    for (size_t i = 1U; i < exec_count && i < TEST_TIMEBASE_LOG_SIZE; ++i)
+        TEST_ASSERT_GREATER_OR_EQUAL(exec_log[i - 1U].t, exec_log[i].t);
+}
+
+void test_timebase_routine_disabled_task() {
+    tasks_set_enable(TASKS_ID_RUN_BMS_MANAGER, false);
+    run(100U);
+
+    for (size_t i = 0U; i < exec_count && i < TEST_TIMEBASE_LOG_SIZE; ++i)
+        TEST_ASSERT_NOT_EQUAL(TASKS_ID_RUN_BMS_MANAGER, exec_log[i].id);
+}
+
+static size_t count_exec(const TasksId id) {
+    size_t count = 0U;
+    for (size_t i = 0U; i < exec_count && i < TEST_TIMEBASE_LOG_SIZE; ++i) {
+        if (exec_log[i].id == id)
+            ++count;
+    }
+    return count;
+}
+
+static void elapse(const ticks_t ticks) {
+    for (ticks_t i = 0U; i < ticks; ++i)
+        timebase_inc_tick();
+}
+
+void test_timebase_routine_skip() {
+    // Elapse multiple ticks without running the routine
+    elapse(25U);
+    flush();
+
+    // Late tasks are executed only once and keep their phase
+    TEST_ASSERT_EQUAL(1U, count_exec(TASKS_ID_RUN_BMS_MANAGER));
+    TEST_ASSERT_EQUAL(12U, timebase_get_task_jitter(TASKS_ID_RUN_BMS_MANAGER)->skipped);
+
+    exec_count = 0U;
+    timebase_inc_tick();
+    timebase_routine();
+    TEST_ASSERT_EQUAL(1U, exec_count);
+    TEST_ASSERT_EQUAL(TASKS_ID_RUN_BMS_MANAGER, exec_log[0U].id);
+
+    exec_count = 0U;
+    timebase_inc_tick();
+    timebase_routine();
+    TEST_ASSERT_EQUAL(0U, exec_count);
+}
+
+void test_timebase_routine_catch_up() {
+    tasks_get_task(TASKS_ID_RUN_BMS_MANAGER)->policy = TASKS_POLICY_CATCH_UP;
+    elapse(7U);
+    timebase_routine();
+
+    // The deadlines at 0, 2, 4 and 6 are all recovered
+    TEST_ASSERT_EQUAL(4U, count_exec(TASKS_ID_RUN_BMS_MANAGER));
+    TEST_ASSERT_EQUAL(0U, timebase_get_task_jitter(TASKS_ID_RUN_BMS_MANAGER)->skipped);
+
+    exec_count = 0U;
+    timebase_inc_tick();
+    timebase_routine();
+    TEST_ASSERT_EQUAL(1U, count_exec(TASKS_ID_RUN_BMS_MANAGER));
+}
+
+void test_timebase_routine_catch_up_limit() {
+    tasks_get_task(TASKS_ID_RUN_BMS_MANAGER)->policy = TASKS_POLICY_CATCH_UP;
+    elapse(2U * (TIMEBASE_CATCH_UP_MAX_RELEASES + 1U));
+    timebase_routine();
+
+    // Too many deadlines elapsed so they are skipped
+    TEST_ASSERT_EQUAL(1U, count_exec(TASKS_ID_RUN_BMS_MANAGER));
+    TEST_ASSERT_EQUAL(TIMEBASE_CATCH_UP_MAX_RELEASES + 1U, timebase_get_task_jitter(TASKS_ID_RUN_BMS_MANAGER)->skipped);
+}
+
+void test_timebase_routine_no_drift() {
+    // Run the routine only every 3 ticks
+    const ticks_t ticks = 3000U;
+    for (ticks_t i = 0U; i < ticks; ++i) {
+        if (i % 3U == 0U)
+            timebase_routine();
+        timebase_inc_tick();
+    }
+
+    // The n-th execution happens within 3 ticks from the n-th deadline
+    const ticks_t interval = tasks_get_interval(TASKS_ID_READ_TEMPERATURES);
+    size_t n = 0U;
+    for (size_t i = 0U; i < exec_count && i < TEST_TIMEBASE_LOG_SIZE; ++i) {
+        if (exec_log[i].id != TASKS_ID_READ_TEMPERATURES)
+            continue;
+        TEST_ASSERT_GREATER_OR_EQUAL(n * interval, exec_log[i].t);
+        TEST_ASSERT_LESS_THAN(n * interval + 3U, exec_log[i].t);
+        ++n;
+    }
+    TEST_ASSERT_EQUAL(ticks / interval, n);
+}
+
+void test_timebase_routine_priority() {
+    watchdog_start(&watchdogs[0U]);
+    elapse(1000U);
+    timebase_routine();
+
+    // High priority tasks run first, then the watchdogs and then the others within the budget
+    TEST_ASSERT_EQUAL(2U + TIMEBASE_ROUTINE_BUDGET, exec_count);
+    TEST_ASSERT_EQUAL(TASKS_ID_READ_TEMPERATURES, exec_log[0U].id);
+    TEST_ASSERT_EQUAL(TASKS_ID_RUN_BMS_MANAGER, exec_log[1U].id);
+    TEST_ASSERT_EQUAL(1U, expired_count);
+    TEST_ASSERT_EQUAL(2U, expired_exec_count);
+    for (size_t i = 2U; i < exec_count; ++i)
+        TEST_ASSERT_EQUAL(TASKS_PRIORITY_LOW, tasks_get_task(exec_log[i].id)->priority);
+}
+
+void test_timebase_routine_budget_deferred() {
+    elapse(1000U);
+
+    // The deferred tasks are executed on the following passes without any new tick
+    size_t low = 0U;
+    for (size_t i = 0U; i < TASKS_COUNT; ++i) {
+        if (tasks_is_enabled(i) && tasks_get_task(i)->priority == TASKS_PRIORITY_LOW)
+            ++low;
+    }
+    for (size_t i = 0U; i < low; ++i) {
+        exec_count = 0U;
+        timebase_routine();
+        if (exec_count == 0U)
+            break;
+        TEST_ASSERT_LESS_OR_EQUAL(TIMEBASE_ROUTINE_BUDGET + (i == 0U ? 2U : 0U), exec_count);
+    }
+    exec_count = 0U;
+    timebase_routine();
+    TEST_ASSERT_EQUAL(0U, exec_count);
+    for (size_t i = 0U; i < TASKS_COUNT; ++i) {
+        if (tasks_is_enabled(i))
+            TEST_ASSERT_EQUAL(1U, timebase_get_task_jitter(i)->bins[TIMEBASE_JITTER_BIN_COUNT - 1U]);
+    }
+}
+
+void test_timebase_jitter_on_time() {
+    run(100U);
+
+    const TimebaseTaskJitter * const jitter = timebase_get_task_jitter(TASKS_ID_RUN_BMS_MANAGER);
+    TEST_ASSERT_EQUAL(50U, jitter->bins[0U]);
+    TEST_ASSERT_EQUAL(0U, jitter->max);
+    TEST_ASSERT_EQUAL(0U, jitter->skipped);
+}
+
+void test_timebase_jitter_histogram() {
+    // Every task is executed 5 ticks late the first time
+    elapse(5U);
+    run(1U);
+
+    const TimebaseTaskJitter * const jitter = timebase_get_task_jitter(TASKS_ID_READ_TEMPERATURES);
+    TEST_ASSERT_EQUAL(1U, jitter->bins[3U]);
+    TEST_ASSERT_EQUAL(5U, jitter->max);
+
+    // The delay of the last bin is saturated
+    timebase_reset_jitter();
+    elapse(1000U);
+    timebase_routine();
+    TEST_ASSERT_EQUAL(1U, jitter->bins[TIMEBASE_JITTER_BIN_COUNT - 1U]);
+    TEST_ASSERT_EQUAL(0U, jitter->bins[3U]);
+}
+
+void test_timebase_jitter_invalid_task() {
+    TEST_ASSERT_NULL(timebase_get_task_jitter(TASKS_COUNT));
+}
+
+void test_timebase_register_watchdog_null() {
+    TEST_ASSERT_EQUAL(TIMEBASE_NULL_POINTER, timebase_register_watchdog(NULL));
+}
+
+void test_timebase_register_watchdog_ok() {
+    TEST_ASSERT_EQUAL(TIMEBASE_OK, timebase_register_watchdog(&watchdogs[0U]));
+    TEST_ASSERT_TRUE(timebase_is_registered_watchdog(&watchdogs[0U]));
+}
+
+void test_timebase_register_watchdog_busy() {
+    timebase_register_watchdog(&watchdogs[0U]);
+    TEST_ASSERT_EQUAL(TIMEBASE_BUSY, timebase_register_watchdog(&watchdogs[0U]));
+}
+
+void test_timebase_register_watchdog_unavailable() {
+    for (size_t i = 0U; i < TIMEBASE_RUNNING_WATCHDOG_COUNT; ++i)
+        TEST_ASSERT_EQUAL(TIMEBASE_OK, timebase_register_watchdog(&watchdogs[i]));
+    TEST_ASSERT_EQUAL(TIMEBASE_WATCHDOG_UNAVAILABLE, timebase_register_watchdog(&watchdogs[TIMEBASE_RUNNING_WATCHDOG_COUNT]));
+}
+
+void test_timebase_register_watchdog_after_init() {
+    timebase_register_watchdog(&watchdogs[0U]);
+    timebase_init(1U, NULL, NULL);
+    TEST_ASSERT_FALSE(timebase_is_registered_watchdog(&watchdogs[0U]));
+    TEST_ASSERT_EQUAL(TIMEBASE_OK, timebase_register_watchdog(&watchdogs[0U]));
+}
+
+void test_timebase_unregister_watchdog_not_registered() {
+    TEST_ASSERT_EQUAL(TIMEBASE_WATCHDOG_NOT_REGISTERED, timebase_unregister_watchdog(&watchdogs[0U]));
+}
+
+void test_timebase_unregister_watchdog_ok() {
+    timebase_register_watchdog(&watchdogs[0U]);
+    timebase_register_watchdog(&watchdogs[1U]);
+    TEST_ASSERT_EQUAL(TIMEBASE_OK, timebase_unregister_watchdog(&watchdogs[0U]));
+    TEST_ASSERT_FALSE(timebase_is_registered_watchdog(&watchdogs[0U]));
+    TEST_ASSERT_TRUE(timebase_is_registered_watchdog(&watchdogs[1U]));
+}
+
+void test_timebase_update_watchdog_not_registered() {
+    TEST_ASSERT_EQUAL(TIMEBASE_WATCHDOG_NOT_REGISTERED, timebase_update_watchdog(&watchdogs[0U]));
+}
+
+void test_timebase_update_watchdog_postpone() {
+    watchdog_start(&watchdogs[0U]);
+    run(5U);
+    TEST_ASSERT_EQUAL(TIMEBASE_OK, timebase_update_watchdog(&watchdogs[0U]));
+    run(10U);
+    TEST_ASSERT_FALSE(watchdog_is_timed_out(&watchdogs[0U]));
+    run(1U);
+    TEST_ASSERT_TRUE(watchdog_is_timed_out(&watchdogs[0U]));
+}
+
+void test_timebase_routine_watchdog_timeout_order() {
+    for (size_t i = TIMEBASE_RUNNING_WATCHDOG_COUNT; i > 0U; --i)
+        watchdog_start(&watchdogs[i - 1U]);
+
+    // Each watchdog has a timeout that is 10 ticks longer than the previous one
+    for (size_t i = 0U; i < TIMEBASE_RUNNING_WATCHDOG_COUNT; ++i) {
+        run(10U);
+        timebase_routine();
+        TEST_ASSERT_EQUAL(i + 1U, expired_count);
+        TEST_ASSERT_TRUE(watchdog_is_timed_out(&watchdogs[i]));
+        if (i + 1U < TIMEBASE_RUNNING_WATCHDOG_COUNT)
+            TEST_ASSERT_FALSE(watchdog_is_timed_out(&watchdogs[i + 1U]));
+    }
+}
+
+void test_timebase_routine_watchdog_random_operations() {
+    ticks_t deadline[TIMEBASE_RUNNING_WATCHDOG_COUNT] = { 0U };
+    srand(42U);
+
+    for (size_t step = 0U; step < 5000U; ++step) {
+        const size_t i = (size_t)rand() % TIMEBASE_RUNNING_WATCHDOG_COUNT;
+        Watchdog * const watchdog = &watchdogs[i];
+        switch (rand() % 3) {
+            case 0:
+                if (watchdog_restart(watchdog) == WATCHDOG_OK)
+                    deadline[i] = timebase_get_tick() + watchdog->timeout;
+                break;
+            case 1:
+                if (watchdog_reset(watchdog) == WATCHDOG_OK)
+                    deadline[i] = timebase_get_tick() + watchdog->timeout;
+                break;
+            default:
+                (void)watchdog_stop(watchdog);
+                break;
+        }
+        timebase_routine();
+        timebase_inc_tick();
+
+        // Every running watchdog must time-out exactly at its deadline
+        for (size_t j = 0U; j < TIMEBASE_RUNNING_WATCHDOG_COUNT; ++j) {
+            if (watchdogs[j].running)
+                TEST_ASSERT_GREATER_THAN(timebase_get_tick() - 1U, deadline[j]);
+            TEST_ASSERT_EQUAL(watchdogs[j].running, timebase_is_registered_watchdog(&watchdogs[j]));
+        }
+    }
+}
+
+void test_timebase_init_clock_null() {
+    TEST_ASSERT_EQUAL(TIMEBASE_NULL_POINTER, timebase_init(1U, clock_get, NULL));
+    TEST_ASSERT_EQUAL(TIMEBASE_NULL_POINTER, timebase_init(1U, NULL, clock_set_alarm));
+}
+
+void test_timebase_get_next_deadline_tasks() {
+    flush();
+
+    // The first tasks that have not run yet or the next execution of the ones that started at tick 0
+    ticks_t expected = tasks_get_interval(TASKS_ID_RUN_BMS_MANAGER);
+    for (TasksId i = 0U; i < TASKS_COUNT; ++i) {
+        if (tasks_is_enabled(i) && tasks_get_start(i) > 0U)
+            expected = CELLBOARD_MIN(expected, tasks_get_start(i));
+    }
+    TEST_ASSERT_EQUAL(expected, timebase_get_next_deadline());
+}
+
+void test_timebase_get_next_deadline_disabled_task() {
+    flush();
+
+    // The disabled tasks are skipped even if their deadline is the earliest one
+    tasks_set_enable(TASKS_ID_RUN_BMS_MANAGER, false);
+    ticks_t expected = TIMEBASE_MS_TO_TICKS(TIMEBASE_CLOCK_MAX_IDLE_MS, 1U);
+    for (TasksId i = 0U; i < TASKS_COUNT; ++i) {
+        if (!tasks_is_enabled(i))
+            continue;
+        const ticks_t deadline = (tasks_get_start(i) > 0U) ? tasks_get_start(i) : tasks_get_interval(i);
+        expected = CELLBOARD_MIN(expected, deadline);
+    }
+    TEST_ASSERT_EQUAL(expected, timebase_get_next_deadline());
+}
+
+void test_timebase_get_next_deadline_watchdog() {
+    flush();
+    watchdog_init(&watchdogs[0U], 1U, expire);
+    watchdog_start(&watchdogs[0U]);
+    TEST_ASSERT_EQUAL(1U, timebase_get_next_deadline());
+}
+
+void test_timebase_get_next_deadline_max_idle() {
+    flush();
+    for (size_t i = 0U; i < TASKS_COUNT; ++i)
+        tasks_set_enable(i, false);
+    TEST_ASSERT_LESS_OR_EQUAL(TIMEBASE_MS_TO_TICKS(TIMEBASE_CLOCK_MAX_IDLE_MS, 1U), timebase_get_next_deadline());
+}
+
+void test_timebase_tickless_update_time() {
+    setup_timebase(clock_get, clock_set_alarm);
+
+    clock_counter += 2500U;
+    timebase_routine();
+    TEST_ASSERT_EQUAL(2U, timebase_get_tick());
+
+    // The remaining part of a tick is kept for the next update
+    clock_counter += 500U;
+    timebase_routine();
+    TEST_ASSERT_EQUAL(3U, timebase_get_tick());
+}
+
+void test_timebase_tickless_disabled() {
+    setup_timebase(clock_get, clock_set_alarm);
+    timebase_set_enable(false);
+
+    // The time elapsed while disabled is ignored
+    clock_counter += 5000U;
+    timebase_set_enable(true);
+    timebase_routine();
+    TEST_ASSERT_EQUAL(0U, timebase_get_tick());
+}
+
+void test_timebase_tickless_counter_overflow() {
+    clock_counter = UINT32_MAX - 1500U;
+    setup_timebase(clock_get, clock_set_alarm);
+
+    clock_counter += 3000U;
+    timebase_routine();
+    TEST_ASSERT_EQUAL(3U, timebase_get_tick());
+}
+
+void test_timebase_tickless_set_alarm() {
+    setup_timebase(clock_get, clock_set_alarm);
+    timebase_routine();
+
+    const uint32_t counts_per_tick = TIMEBASE_CLOCK_FREQUENCY_HZ / 1000U;
+    TEST_ASSERT_EQUAL(1U, clock_alarm_count);
+    TEST_ASSERT_EQUAL(timebase_get_next_deadline() * counts_per_tick, clock_alarm);
+}
+
+void test_timebase_tickless_wake_up_count() {
+    const ticks_t ticks = 1000U;
+
+    // Run the tick-driven timebase as a reference
+    run(ticks);
+    const size_t expected = exec_count;
+
+    // Wake up only when the alarm triggers
+    setup_timebase(clock_get, clock_set_alarm);
+    size_t wake_up_count = 0U;
+    timebase_routine();
+    while (clock_alarm < ticks * (TIMEBASE_CLOCK_FREQUENCY_HZ / 1000U)) {
+        clock_counter = clock_alarm;
+        timebase_routine();
+        ++wake_up_count;
+    }
+
+    // The same tasks are executed with less wake ups than the number of ticks
+    TEST_ASSERT_EQUAL(expected, exec_count);
+    TEST_ASSERT_LESS_THAN(ticks, wake_up_count);
+    for (size_t i = 0U; i < exec_count && i < TEST_TIMEBASE_LOG_SIZE; ++i) {
+        const ticks_t start = tasks_get_start(exec_log[i].id);
+        TEST_ASSERT_EQUAL(0U, (exec_log[i].t - start) % tasks_get_interval(exec_log[i].id));
+    }
+}
+
+void test_tasks_set_interval_invalid_id() {
+    TEST_ASSERT_EQUAL(TASKS_INVALID_ID, tasks_set_interval(TASKS_ID_COUNT, 100U));
+}
+
+void test_tasks_set_interval_out_of_bounds() {
+    const ticks_t interval = tasks_get_interval(TASKS_ID_SEND_STATUS);
+    TEST_ASSERT_EQUAL(TASKS_INVALID_INTERVAL, tasks_set_interval(TASKS_ID_SEND_STATUS, TASKS_INTERVAL_MIN_MS - 1U));
+    TEST_ASSERT_EQUAL(TASKS_INVALID_INTERVAL, tasks_set_interval(TASKS_ID_SEND_STATUS, TASKS_INTERVAL_MAX_MS + 1U));
+    TEST_ASSERT_EQUAL(interval, tasks_get_interval(TASKS_ID_SEND_STATUS));
+}
+
+void test_tasks_set_interval_shorter() {
+    run(100U);
+    TEST_ASSERT_EQUAL(1U, count_exec(TASKS_ID_SEND_STATUS));
+
+    // The task is released within the new interval instead of the old deadline
+    TEST_ASSERT_EQUAL(TASKS_OK, tasks_set_interval(TASKS_ID_SEND_STATUS, 10U));
+    TEST_ASSERT_EQUAL(10U, tasks_get_interval(TASKS_ID_SEND_STATUS));
+    TEST_ASSERT_LESS_OR_EQUAL(110U, timebase_get_next_deadline());
+    run(100U);
+    TEST_ASSERT_GREATER_OR_EQUAL(10U, count_exec(TASKS_ID_SEND_STATUS));
+    TEST_ASSERT_LESS_OR_EQUAL(11U, count_exec(TASKS_ID_SEND_STATUS));
+}
+
+void test_tasks_set_interval_longer() {
+    const milliseconds_t interval = tasks_get_interval(TASKS_ID_SEND_TEMPERATURES);
+    run(60U);
+    TEST_ASSERT_EQUAL(1U, count_exec(TASKS_ID_SEND_TEMPERATURES));
+
+    // The current deadline is kept and the new interval is used from there on
+    TEST_ASSERT_EQUAL(TASKS_OK, tasks_set_interval(TASKS_ID_SEND_TEMPERATURES, 10U * interval));
+    run(interval);
+    TEST_ASSERT_EQUAL(2U, count_exec(TASKS_ID_SEND_TEMPERATURES));
+    run(10U * interval - 100U);
+    TEST_ASSERT_EQUAL(2U, count_exec(TASKS_ID_SEND_TEMPERATURES));
+    run(200U);
+    TEST_ASSERT_EQUAL(3U, count_exec(TASKS_ID_SEND_TEMPERATURES));
+}
+
+#ifdef CONF_TASKS_TDMA_ENABLE
+
+void test_tasks_tdma_start() {
+    ticks_t start[TASKS_COUNT];
+    for (TasksId i = 0U; i < TASKS_COUNT; ++i)
+        start[i] = tasks_get_start(i);
+
+    // Each cellboard is moved forward by a slot from the previous one
+    for (CellboardId id = CELLBOARD_ID_1; id < CELLBOARD_COUNT; ++id) {
+        identity_init(id);
+        tasks_init(1U);
+#define TASKS_TDMA_X(NAME, PHASE, SLOT) \
+        TEST_ASSERT_EQUAL(start[TASKS_ID_##NAME] + (SLOT) * id, tasks_get_start(TASKS_ID_##NAME));
+        TASKS_TDMA_X_LIST
+#undef TASKS_TDMA_X
+
+        // The tasks used to monitor the cells are not moved
+        TEST_ASSERT_EQUAL(start[TASKS_ID_READ_TEMPERATURES], tasks_get_start(TASKS_ID_READ_TEMPERATURES));
+        TEST_ASSERT_EQUAL(start[TASKS_ID_RUN_BMS_MANAGER], tasks_get_start(TASKS_ID_RUN_BMS_MANAGER));
+    }
+    identity_init(CELLBOARD_ID_0);
+}
+
+void test_tasks_tdma_slots_fit_interval() {
+#define TASKS_TDMA_X(NAME, PHASE, SLOT) \
+    TEST_ASSERT_LESS_OR_EQUAL(tasks_get_interval(TASKS_ID_##NAME), (PHASE) + (SLOT) * CELLBOARD_COUNT);
+    TASKS_TDMA_X_LIST
+#undef TASKS_TDMA_X
+}
+
+void test_tasks_tdma_set_interval_scaled() {
+    const ticks_t base = tasks_get_start(TASKS_ID_SEND_VOLTAGES);
+    const ticks_t interval = tasks_get_interval(TASKS_ID_SEND_VOLTAGES);
+
+    // The slots are scaled with the interval so they never overlap nor leave it
+    ticks_t previous = 0U;
+    for (CellboardId id = CELLBOARD_ID_0; id < CELLBOARD_COUNT; ++id) {
+        identity_init(id);
+        tasks_init(1U);
+        TEST_ASSERT_EQUAL(TASKS_OK, tasks_set_interval(TASKS_ID_SEND_VOLTAGES, interval / 5U));
+        const ticks_t start = tasks_get_start(TASKS_ID_SEND_VOLTAGES);
+        if (id > CELLBOARD_ID_0)
+            TEST_ASSERT_GREATER_THAN(previous, start);
+        TEST_ASSERT_LESS_THAN(base + interval / 5U, start);
+        previous = start;
+
+        // The default interval gives back the default slot
+        TEST_ASSERT_EQUAL(TASKS_OK, tasks_set_interval(TASKS_ID_SEND_VOLTAGES, interval));
+        TEST_ASSERT_EQUAL(base + 7U * id, tasks_get_start(TASKS_ID_SEND_VOLTAGES));
+    }
+    identity_init(CELLBOARD_ID_0);
+}
+
+void test_tasks_tdma_set_interval_aligned() {
+    identity_init(CELLBOARD_ID_3);
+    setup_timebase(NULL, NULL);
+    run(123U);
+    const size_t before = count_exec(TASKS_ID_SEND_VOLTAGES);
+    const size_t first = exec_count;
+
+    // The task is moved to the deadlines of the new slot of the cellboard
+    TEST_ASSERT_EQUAL(TASKS_OK, tasks_set_interval(TASKS_ID_SEND_VOLTAGES, 10U));
+    const ticks_t start = tasks_get_start(TASKS_ID_SEND_VOLTAGES);
+    run(100U);
+    TEST_ASSERT_EQUAL(before + 10U, count_exec(TASKS_ID_SEND_VOLTAGES));
+    for (size_t i = first; i < exec_count; ++i) {
+        if (exec_log[i].id == TASKS_ID_SEND_VOLTAGES)
+            TEST_ASSERT_EQUAL(0U, (exec_log[i].t - start) % 10U);
+    }
+    identity_init(CELLBOARD_ID_0);
+}
+
+void test_tasks_tdma_routine() {
+    identity_init(CELLBOARD_ID_2);
+    setup_timebase(NULL, NULL);
+    run(tasks_get_start(TASKS_ID_SEND_VOLTAGES));
+    TEST_ASSERT_EQUAL(0U, count_exec(TASKS_ID_SEND_VOLTAGES));
+    run(1U);
+    TEST_ASSERT_EQUAL(1U, count_exec(TASKS_ID_SEND_VOLTAGES));
+    identity_init(CELLBOARD_ID_0);
+}
+
+#endif // CONF_TASKS_TDMA_ENABLE
+
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+
+void test_timebase_profiler_init_null() {
+    TEST_ASSERT_EQUAL(TIMEBASE_NULL_POINTER, timebase_profiler_init(NULL));
+}
+
+void test_timebase_profiler_get_task_invalid() {
+    TEST_ASSERT_NULL(timebase_profiler_get_task(TASKS_COUNT));
+    TEST_ASSERT_EQUAL(0U, timebase_profiler_get_mean(TASKS_COUNT));
+}
+
+void test_timebase_profiler_statistics() {
+    timebase_profiler_init(profiler_clock_get);
+    task_cost = 100U;
+    run(10U);
+
+    const TimebaseTaskProfile * const profile = timebase_profiler_get_task(TASKS_ID_RUN_BMS_MANAGER);
+    TEST_ASSERT_EQUAL(5U, profile->count);
+    TEST_ASSERT_EQUAL(100U, profile->min);
+    TEST_ASSERT_EQUAL(100U, profile->max);
+    TEST_ASSERT_EQUAL(100U, timebase_profiler_get_mean(TASKS_ID_RUN_BMS_MANAGER));
+    TEST_ASSERT_EQUAL(0U, profile->overruns);
+}
+
+void test_timebase_profiler_overruns() {
+    timebase_profiler_init(profiler_clock_get);
+
+    // Every task lasts 3 ms
+    task_cost = 3U * (TIMEBASE_PROFILER_CLOCK_FREQUENCY_HZ / 1000U);
+    run(10U);
+
+    TEST_ASSERT_EQUAL(5U, timebase_profiler_get_task(TASKS_ID_RUN_BMS_MANAGER)->overruns);
+    TEST_ASSERT_EQUAL(0U, timebase_profiler_get_task(TASKS_ID_READ_TEMPERATURES)->overruns);
+}
+
+void test_timebase_profiler_reset() {
+    timebase_profiler_init(profiler_clock_get);
+    task_cost = 100U;
+    run(10U);
+    timebase_profiler_reset();
+    TEST_ASSERT_EQUAL(0U, timebase_profiler_get_task(TASKS_ID_RUN_BMS_MANAGER)->count);
+    TEST_ASSERT_EQUAL(0U, timebase_profiler_get_mean(TASKS_ID_RUN_BMS_MANAGER));
+}
+
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_timebase_init_ok);
+    RUN_TEST(test_timebase_init_resolution_zero);
+    RUN_TEST(test_timebase_inc_tick_disabled);
+    RUN_TEST(test_timebase_routine_disabled);
+#ifdef CONF_TIMEBASE_WHEEL_ENABLE
+    RUN_TEST(test_timebase_wheel_init);
+#endif // CONF_TIMEBASE_WHEEL_ENABLE
+    RUN_TEST(test_timebase_routine_first_tick);
+    RUN_TEST(test_timebase_routine_tasks_deadline);
+    RUN_TEST(test_timebase_routine_tasks_order);
+    RUN_TEST(test_timebase_routine_disabled_task);
+    RUN_TEST(test_timebase_routine_skip);
+    RUN_TEST(test_timebase_routine_catch_up);
+    RUN_TEST(test_timebase_routine_catch_up_limit);
+    RUN_TEST(test_timebase_routine_no_drift);
+    RUN_TEST(test_timebase_routine_priority);
+    RUN_TEST(test_timebase_routine_budget_deferred);
+    RUN_TEST(test_timebase_jitter_on_time);
+    RUN_TEST(test_timebase_jitter_histogram);
+    RUN_TEST(test_timebase_jitter_invalid_task);
+    RUN_TEST(test_timebase_register_watchdog_null);
+    RUN_TEST(test_timebase_register_watchdog_ok);
+    RUN_TEST(test_timebase_register_watchdog_busy);
+    RUN_TEST(test_timebase_register_watchdog_unavailable);
+    RUN_TEST(test_timebase_register_watchdog_after_init);
+    RUN_TEST(test_timebase_unregister_watchdog_not_registered);
+    RUN_TEST(test_timebase_unregister_watchdog_ok);
+    RUN_TEST(test_timebase_update_watchdog_not_registered);
+    RUN_TEST(test_timebase_update_watchdog_postpone);
+    RUN_TEST(test_timebase_routine_watchdog_timeout_order);
+    RUN_TEST(test_timebase_routine_watchdog_random_operations);
+    RUN_TEST(test_timebase_init_clock_null);
+    RUN_TEST(test_timebase_get_next_deadline_tasks);
+    RUN_TEST(test_timebase_get_next_deadline_disabled_task);
+    RUN_TEST(test_timebase_get_next_deadline_watchdog);
+    RUN_TEST(test_timebase_get_next_deadline_max_idle);
+    RUN_TEST(test_timebase_tickless_update_time);
+    RUN_TEST(test_timebase_tickless_disabled);
+    RUN_TEST(test_timebase_tickless_counter_overflow);
+    RUN_TEST(test_timebase_tickless_set_alarm);
+    RUN_TEST(test_timebase_tickless_wake_up_count);
+    RUN_TEST(test_tasks_set_interval_invalid_id);
+    RUN_TEST(test_tasks_set_interval_out_of_bounds);
+#ifndef CONF_TASKS_TDMA_ENABLE
+    RUN_TEST(test_tasks_set_interval_shorter);
+#endif // CONF_TASKS_TDMA_ENABLE
+    RUN_TEST(test_tasks_set_interval_longer);
+#ifdef CONF_TASKS_TDMA_ENABLE
+    RUN_TEST(test_tasks_tdma_start);
+    RUN_TEST(test_tasks_tdma_slots_fit_interval);
+    RUN_TEST(test_tasks_tdma_set_interval_scaled);
+    RUN_TEST(test_tasks_tdma_set_interval_aligned);
+    RUN_TEST(test_tasks_tdma_routine);
+#endif // CONF_TASKS_TDMA_ENABLE
+#ifdef CONF_TIMEBASE_PROFILER_ENABLE
+    RUN_TEST(test_timebase_profiler_init_null);
+    RUN_TEST(test_timebase_profiler_get_task_invalid);
+    RUN_TEST(test_timebase_profiler_statistics);
+    RUN_TEST(test_timebase_profiler_overruns);
+    RUN_TEST(test_timebase_profiler_reset);
+#endif // CONF_TIMEBASE_PROFILER_ENABLE
+    return UNITY_END();
+}
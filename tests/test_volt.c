@@ -6,10 +6,14 @@
  * @brief Test functions for the voltage module
  */
 
+#include <string.h>
+
 #include "unity.h"
 #include "volt.h"
 #include "cellboard-def.h"
 #include "identity.h"
+#include "can-comm.h"
+#include "timebase.h"
 
 #define CELLBOARD_ID CELLBOARD_ID_1
 
@@ -17,6 +21,8 @@ extern _VoltHandler hvolt;
 
 void setUp() {
     identity_init(CELLBOARD_ID);
+    timebase_init(1U, NULL, NULL);
+    timebase_set_enable(true);
     volt_init();
 }
 
@@ -27,11 +33,11 @@ void test_volt_init_ok() {
 }
 
 void test_volt_init_cellboard_id() {
-    TEST_ASSERT_EQUAL(hvolt.can_payload.cellboard_id, CELLBOARD_ID);
+    TEST_ASSERT_EQUAL(hvolt.voltages_can_payload.cellboard_id, CELLBOARD_ID);
 }
 
 void test_volt_update_value_ok() {
-    TEST_ASSERT_EQUAL(volt_update_value(0, VOLT_MILLIVOLT_TO_VALUE(VOLT_MIN_VALUE)+2), VOLT_OK);
+    TEST_ASSERT_EQUAL(volt_update_value(0, VOLT_MIN_V + 0.2f), VOLT_OK);
 }
 
 void test_volt_update_value_out_of_bounds() {
@@ -39,80 +45,191 @@ void test_volt_update_value_out_of_bounds() {
 }
 
 void test_volt_update_values_ok() {
-    raw_volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
+    volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
     for (size_t i = 0; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i)
-        values[i] = VOLT_MILLIVOLT_TO_VALUE(VOLT_MIN_VALUE) + i;
+        values[i] = VOLT_MIN_V + i * 0.01f;
 
     TEST_ASSERT_EQUAL(volt_update_values(0, values, CELLBOARD_SEGMENT_SERIES_COUNT), VOLT_OK);
 }
 
 void test_volt_update_values_out_of_bounds() {
-    raw_volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
+    volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
     for (size_t i = 0; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i)
-        values[i] = VOLT_MILLIVOLT_TO_VALUE(VOLT_MIN_VALUE) + i;
+        values[i] = VOLT_MIN_V + i * 0.01f;
 
     TEST_ASSERT_EQUAL(volt_update_values(CELLBOARD_SEGMENT_SERIES_COUNT + 1, values, CELLBOARD_SEGMENT_SERIES_COUNT), VOLT_OUT_OF_BOUNDS);
 }
 
 void test_volt_get_values() {
-    raw_volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
+    volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
     for (size_t i = 0; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i)
-        values[i] = VOLT_MILLIVOLT_TO_VALUE(VOLT_MIN_VALUE) + i;
+        values[i] = VOLT_MIN_V + i * 0.01f;
 
     volt_update_values(0, values, CELLBOARD_SEGMENT_SERIES_COUNT);
-    const raw_volt_t * out = volt_get_values();
+    const cells_volt_t * out = volt_get_values();
     for (size_t i = 0; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i)
-        TEST_ASSERT_EQUAL(out[i], values[i]);
+        TEST_ASSERT_EQUAL_FLOAT(values[i], (*out)[i]);
 }
 
 void test_volt_select_values() {
-    raw_volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
+    volt_t values[CELLBOARD_SEGMENT_SERIES_COUNT];
     for (size_t i = 0; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i)
-        values[i] = VOLT_MIN_VALUE + i;
+        values[i] = VOLT_MIN_V + i * 0.01f;
 
     volt_update_values(0, values, CELLBOARD_SEGMENT_SERIES_COUNT);
-    bit_flag32_t bits = volt_select_values(VOLT_VALUE_TO_MILLIVOLT(VOLT_MIN_VALUE));
+    bit_flag32_t bits = volt_select_values(VOLT_MIN_V);
 
     TEST_ASSERT_BITS_HIGH(0xFFFFFE, bits);
 }
 
 void test_volt_get_canlib_payload_size() {
+    size_t byte_size;
+    volt_get_canlib_payload(&byte_size);
 
-    raw_volt_t values[4];
-    for (size_t i = 0; i < 4; ++i)
-        values[i] = VOLT_MIN_VALUE + i;
+    TEST_ASSERT_EQUAL(sizeof(hvolt.voltages_can_payload), byte_size);
+}
 
-    volt_update_values(0, values, 4);
+void test_volt_get_canlib_payload_voltage() {
+    volt_t values[VOLT_CAN_GROUP_SIZE];
+    for (size_t i = 0; i < VOLT_CAN_GROUP_SIZE; ++i)
+        values[i] = VOLT_MIN_V + i * 0.01f;
 
-    size_t byte_size;
-    bms_cellboard_cells_voltage_converted_t * payload = volt_get_canlib_payload(&byte_size);
+    volt_update_values(0, values, VOLT_CAN_GROUP_SIZE);
 
-    TEST_ASSERT_EQUAL(sizeof(hvolt.can_payload), byte_size);
+    const volt_canlib_payload_t * payload = volt_get_canlib_payload(NULL);
+
+    TEST_ASSERT_NOT_NULL(payload);
+    TEST_ASSERT_EQUAL(CELLBOARD_ID, payload->cellboard_id);
+    TEST_ASSERT_EQUAL(0U, payload->offset);
+#ifndef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    TEST_ASSERT_EQUAL_FLOAT(values[0], payload->voltage_0);
+    TEST_ASSERT_EQUAL_FLOAT(values[1], payload->voltage_1);
+    TEST_ASSERT_EQUAL_FLOAT(values[2], payload->voltage_2);
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
 }
 
-void test_volt_get_canlib_payload_voltage() {
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+
+/** @brief Send every group once to fill the values known by the receiver */
+static void adaptive_send_all(void) {
+    for (size_t i = 0U; i < VOLT_CAN_GROUP_COUNT; ++i)
+        volt_get_canlib_payload(NULL);
+}
 
-    raw_volt_t values[4];
+void test_volt_adaptive_first_round() {
+    for (size_t i = 0U; i < VOLT_CAN_GROUP_COUNT; ++i) {
+        const volt_canlib_payload_t * const payload = volt_get_canlib_payload(NULL);
+        TEST_ASSERT_NOT_NULL(payload);
+        TEST_ASSERT_EQUAL(i * VOLT_CAN_GROUP_SIZE, payload->offset);
+    }
+    TEST_ASSERT_EQUAL(VOLT_CAN_GROUP_COUNT, hvolt.sent_count);
+    TEST_ASSERT_EQUAL(0U, hvolt.saved_count);
+}
 
-    for (size_t i = 0; i < 4; ++i)
-        values[i] = VOLT_MIN_VALUE + i;
+void test_volt_adaptive_unchanged() {
+    adaptive_send_all();
+    TEST_ASSERT_NULL(volt_get_canlib_payload(NULL));
+    TEST_ASSERT_EQUAL(VOLT_CAN_GROUP_COUNT, hvolt.sent_count);
+    TEST_ASSERT_EQUAL(1U, hvolt.saved_count);
+}
 
-    volt_update_values(0, values, 4);
+void test_volt_adaptive_deadband() {
+    adaptive_send_all();
 
-    size_t byte_size;
-    bms_cellboard_cells_voltage_converted_t* payload = volt_get_canlib_payload(&byte_size);
+    // A change inside the deadband is not sent
+    volt_update_value(VOLT_CAN_GROUP_SIZE + 1U, VOLT_DEADBAND_V * 0.5f);
+    TEST_ASSERT_NULL(volt_get_canlib_payload(NULL));
+
+    // Only the group of the value that moved outside the deadband is sent
+    volt_update_value(VOLT_CAN_GROUP_SIZE + 1U, VOLT_DEADBAND_V * 2.f);
+    const volt_canlib_payload_t * const payload = volt_get_canlib_payload(NULL);
+    TEST_ASSERT_NOT_NULL(payload);
+    TEST_ASSERT_EQUAL(VOLT_CAN_GROUP_SIZE, payload->offset);
+    TEST_ASSERT_NULL(volt_get_canlib_payload(NULL));
+}
+
+void test_volt_adaptive_refresh() {
+    adaptive_send_all();
+    for (size_t i = 0U; i < VOLT_REFRESH_MS; ++i)
+        timebase_inc_tick();
+
+    // Every group is sent again after the refresh period even if unchanged
+    for (size_t i = 0U; i < VOLT_CAN_GROUP_COUNT; ++i)
+        TEST_ASSERT_NOT_NULL(volt_get_canlib_payload(NULL));
+    TEST_ASSERT_NULL(volt_get_canlib_payload(NULL));
+}
+
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
 
-    bms_cellboard_cells_voltage_converted_t expected_payload;
-    expected_payload.cellboard_id = CELLBOARD_ID;
-    expected_payload.offset = 0;
-    expected_payload.voltage_0 = VOLT_VALUE_TO_MILLIVOLT(values[0]);
-    expected_payload.voltage_1 = VOLT_VALUE_TO_MILLIVOLT(values[1]);
-    expected_payload.voltage_2 = VOLT_VALUE_TO_MILLIVOLT(values[2]);
-    expected_payload.voltage_3 = VOLT_VALUE_TO_MILLIVOLT(values[3]);
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
 
-    TEST_ASSERT_EQUAL_MEMORY(&expected_payload, payload, sizeof(expected_payload));
+void test_volt_update_raw_value_out_of_bounds() {
+    TEST_ASSERT_EQUAL(VOLT_OUT_OF_BOUNDS, volt_update_raw_value(CELLBOARD_SEGMENT_SERIES_COUNT, 0U));
 }
 
+void test_volt_update_raw_value_volt() {
+    volt_update_raw_value(0U, 36000U);
+    TEST_ASSERT_EQUAL_FLOAT(VOLT_RAW_TO_VOLT(36000U), hvolt.voltages[0U]);
+}
+
+/**
+ * @brief Check that every raw value inside the range of the payload is sent as with the converted payload
+ *
+ * @param fallback True to use the canlib conversion even if the integer scaling matches it
+ */
+static void raw_payload_sweep(const bool fallback) {
+    for (raw_volt_t value = VOLT_CAN_RAW_MIN; value <= VOLT_CAN_RAW_MIN + VOLT_CAN_RAW_RANGE; ++value) {
+        volt_init();
+        if (fallback)
+            hvolt.raw_scaling_exact = false;
+        for (size_t i = 0U; i < CELLBOARD_SEGMENT_SERIES_COUNT; ++i)
+            volt_update_raw_value(i, value);
+        const volt_canlib_payload_t * const payload = volt_get_canlib_payload(NULL);
+
+        bms_cellboard_cells_voltage_converted_t conv = {
+            .cellboard_id = payload->cellboard_id,
+            .offset = payload->offset,
+            .voltage_0 = VOLT_RAW_TO_VOLT(value),
+            .voltage_1 = VOLT_RAW_TO_VOLT(value),
+            .voltage_2 = VOLT_RAW_TO_VOLT(value)
+        };
+        bms_cellboard_cells_voltage_t raw;
+        bms_cellboard_cells_voltage_conversion_to_raw_struct(&raw, &conv);
+
+        uint8_t expected[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE] = { 0U };
+        uint8_t actual[CAN_COMM_MAX_PAYLOAD_BYTE_SIZE] = { 0U };
+        bms_cellboard_cells_voltage_pack(expected, &raw, sizeof(expected));
+        bms_cellboard_cells_voltage_pack(actual, payload, sizeof(actual));
+        TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected));
+    }
+}
+
+void test_volt_raw_scaling_exact() {
+    // The integer scaling must reproduce the conversion of the canlib network
+    TEST_ASSERT_TRUE(hvolt.raw_scaling_exact);
+}
+
+void test_volt_raw_payload_bit_identical() {
+    raw_payload_sweep(false);
+}
+
+void test_volt_raw_payload_bit_identical_fallback() {
+    raw_payload_sweep(true);
+}
+
+void test_volt_raw_payload_saturation() {
+    hvolt.raw_scaling_exact = true;
+    volt_update_raw_value(0U, VOLT_CAN_RAW_MIN - 1U);
+    volt_update_raw_value(1U, VOLT_CAN_RAW_MIN + VOLT_CAN_RAW_RANGE + 1U);
+    volt_update_raw_value(2U, UINT16_MAX);
+    const volt_canlib_payload_t * const payload = volt_get_canlib_payload(NULL);
+    TEST_ASSERT_EQUAL(0U, payload->voltage_0);
+    TEST_ASSERT_EQUAL(VOLT_CAN_RAW_MAX, payload->voltage_1);
+    TEST_ASSERT_EQUAL(VOLT_CAN_RAW_MAX, payload->voltage_2);
+}
+
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+
 int main() {
     UNITY_BEGIN();
     RUN_TEST(test_volt_init_ok);
@@ -125,5 +242,19 @@ int main() {
     RUN_TEST(test_volt_select_values);
     RUN_TEST(test_volt_get_canlib_payload_size);
     RUN_TEST(test_volt_get_canlib_payload_voltage);
+#ifdef CONF_TELEMETRY_ADAPTIVE_ENABLE
+    RUN_TEST(test_volt_adaptive_first_round);
+    RUN_TEST(test_volt_adaptive_unchanged);
+    RUN_TEST(test_volt_adaptive_deadband);
+    RUN_TEST(test_volt_adaptive_refresh);
+#endif // CONF_TELEMETRY_ADAPTIVE_ENABLE
+#ifdef CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
+    RUN_TEST(test_volt_update_raw_value_out_of_bounds);
+    RUN_TEST(test_volt_update_raw_value_volt);
+    RUN_TEST(test_volt_raw_scaling_exact);
+    RUN_TEST(test_volt_raw_payload_bit_identical);
+    RUN_TEST(test_volt_raw_payload_bit_identical_fallback);
+    RUN_TEST(test_volt_raw_payload_saturation);
+#endif // CONF_TELEMETRY_RAW_PAYLOAD_ENABLE
     return UNITY_END();
 }